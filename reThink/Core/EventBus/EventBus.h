@@ -2,7 +2,7 @@
 #ifndef EVENTBUS_H
 #define EVENTBUS_H
 
-#include <map>
+#include <unordered_map>
 #include <vector>
 #include <functional>
 #include <typeindex>
@@ -11,19 +11,66 @@
 #include <iostream>
 #include <memory>
 #include<algorithm>
+#include <string>
+#include <type_traits>
+#include <array>
+
+/**
+ * @brief 编译期事件类型列表，为列表中的每个事件类型分配稠密的整数 ID（即其在列表中的下标）。
+ */
+template<typename... EventTypes>
+struct EventTypeList {
+    static constexpr size_t size = sizeof...(EventTypes);
+
+    /**
+     * @brief 返回 T 在列表中的下标，不在列表中时返回 -1。
+     */
+    template<typename T>
+    static constexpr int IndexOf() {
+        constexpr bool matches[] = {std::is_same_v<T, EventTypes>..., false};
+        for (size_t i = 0; i < size; ++i) {
+            if (matches[i]) return static_cast<int>(i);
+        }
+        return -1;
+    }
+};
+
+/**
+ * @brief 事件类型的编译期 ID。默认 -1 表示未注册，由 EventTypes.h 为注册表中的事件特化。
+ * 
+ * 未注册的事件（如各模块头文件中定义的局部事件）仍可使用，会回退到按 std::type_index 查找。
+ */
+template<typename T, typename = void>
+struct EventTypeId : std::integral_constant<int, -1> {};
 
 /**
  * @brief EventBus 是一个线程安全的事件总线，用于模块间解耦通信。
  * 
  * 它支持泛型事件类型，通过 Subscribe 订阅事件，通过 Publish 发布事件，
- * 并提供 Unsubscribe 方法以取消订阅。使用 std::mutex 确保线程安全，
- * 使用 std::type_index 区分不同事件类型。
+ * 并提供 Unsubscribe 方法以取消订阅。EventTypes.h 中注册的事件在编译期获得稠密 ID，
+ * 直接按数组下标定位通道；其余事件使用 std::type_index 查找。
+ *
+ * 订阅者列表采用写时复制（RCU 风格）：Subscribe/Unsubscribe 在 std::mutex 保护下
+ * 构建新的不可变列表并原子替换，Publish 只读取当前快照，无需加锁也不分配内存。
+ * 被替换的旧列表按纪元回收：Publish 登记在当前纪元，旧列表只需等待替换之前的纪元中
+ * 登记的 Publish 全部结束即可释放，持续不断的并发发布不会使其无限堆积。
+ *
+ * 除同步的 Publish 外还提供排队模式：Enqueue 将事件追加到按类型划分的环形缓冲区，
+ * 由 DispatchQueued 每帧统一分发一次。带有 EventKey() 成员的事件在同一帧内按键合并，
+ * 只保留最后一次的内容。
+ *
+ * 带有 EventKey() 成员的事件还支持键控订阅：SubscribeKeyed 只接收键匹配的事件。
+ * 键控订阅者按键哈希分桶，每个桶同样是写时复制的不可变列表，发布时只访问一个桶，
+ * 开销与匹配的订阅者数量相关，而不是与该事件类型的全部订阅者数量相关。
  */
 class EventBus {
 public:
     // 定义订阅者 ID 类型，用于标识和取消订阅
     using SubscriberId = size_t;
 
+    // 编译期注册的事件类型数量上限，决定通道数组的大小
+    static constexpr size_t kMaxEventTypes = 64;
+
     // 优先级枚举定义
     enum class Priority : uint8_t {
         High = 0,    // 最高优先级（如渲染、交互事件）
@@ -37,48 +84,74 @@ public:
     EventBus() = default;
 
     /**
-     * @brief 析构函数，确保资源正确释放。
+     * @brief 析构函数，释放所有订阅者快照与事件通道。
      */
-    ~EventBus() = default;
+    ~EventBus() {
+        delete channelTable_.load();
+    }
 
     // 禁止拷贝和赋值，避免意外的资源管理问题
     EventBus(const EventBus&) = delete;
     EventBus& operator=(const EventBus&) = delete;
 
+    /**
+     * @brief 排队模式的计数器，描述一帧内入队、合并与分发的事件数量。
+     */
+    struct QueueStats {
+        size_t enqueued = 0;    // 入队的事件数量
+        size_t coalesced = 0;   // 因键相同被合并的事件数量
+        size_t dispatched = 0;  // 实际分发的事件数量
+    };
+
     /**
      * @brief 订阅指定类型的事件。
      * 
      * @tparam EventType 事件类型，支持泛型。
-     * @param callback 回调函数，接收事件引用。
+     * @param callback 回调函数，接收事件引用。直接保存可调用对象本身，发布时经由一次函数指针调用。
      * @return SubscriberId 订阅者 ID，用于后续取消订阅。
      */
-    template<typename EventType>
-    SubscriberId Subscribe(std::function<void(const EventType&)> callback, 
+    template<typename EventType, typename F>
+    SubscriberId Subscribe(F&& callback, 
                           Priority priority = Priority::Normal) {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto typeIndex = std::type_index(typeid(EventType));
-        auto& subscribers = subscribers_[typeIndex];
+        Channel& channel = GetOrCreateChannel<EventType>();
 
         // 生成唯一的订阅者 ID
         SubscriberId id = nextId_++;
         
-        // 将回调函数包装为 void(const void*) 类型，并存储
-        subscribers.push_back(Subscriber{
-            id,
-            [callback, typeIndex](const void* event) {
-                try {
-                    callback(*static_cast<const EventType*>(event));
-                } catch (const std::exception& e) {
-                    std::cerr << "Error in event callback for type " 
-                              << typeIndex.name() << ": " << e.what() << std::endl;
-                }
-            },
-            priority  // 新增优先级字段
-        });
-        std::sort(subscribers.begin(), subscribers.end(), 
+        // 基于当前快照构建新列表
+        const SubscriberList* current = channel.subscribers.load();
+        auto* subscribers = current ? new SubscriberList(*current) : new SubscriberList();
+        subscribers->push_back(MakeSubscriber<EventType>(id, std::forward<F>(callback), priority));
+        std::stable_sort(subscribers->begin(), subscribers->end(), 
                           [](const Subscriber& a, const Subscriber& b) {
                               return a.priority < b.priority;
                           });
+        ReplaceSubscribers(channel, subscribers);
+        return id;
+    }
+
+    /**
+     * @brief 订阅指定类型中键匹配的事件。
+     * 
+     * 事件类型必须提供 EventKey() 成员（例如 MaterialUpdatedEvent 的材质 UUID）。
+     * 发布时只有键相同的订阅者会被调用，与普通订阅者一起按优先级排序。
+     * 
+     * @tparam EventType 事件类型，支持泛型。
+     * @param key 订阅的键。
+     * @param callback 回调函数，接收事件引用。
+     * @return SubscriberId 订阅者 ID，可通过 Unsubscribe 取消订阅。
+     */
+    template<typename EventType, typename F>
+    SubscriberId SubscribeKeyed(const std::string& key, F&& callback,
+                                Priority priority = Priority::Normal) {
+        static_assert(HasEventKey<EventType>::value, "EventBus: keyed subscription requires EventType::EventKey()");
+        std::lock_guard<std::mutex> lock(mutex_);
+        Channel& channel = GetOrCreateChannel<EventType>();
+
+        SubscriberId id = nextId_++;
+        size_t hash = std::hash<std::string>{}(key);
+        AddKeyedSubscriber(channel, KeyedSubscriber{hash, key, MakeSubscriber<EventType>(id, std::forward<F>(callback), priority)});
         return id;
     }
 
@@ -90,57 +163,578 @@ public:
      */
     void Unsubscribe(std::type_index typeIndex, SubscriberId id) {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = subscribers_.find(typeIndex);
-        if (it != subscribers_.end()) {
-            auto& subscribers = it->second;
-            subscribers.erase(
-                std::remove_if(subscribers.begin(), subscribers.end(),
-                    [id](const Subscriber& sub) { return sub.id == id; }),
-                subscribers.end()
-            );
-            if (subscribers.empty()) {
-                subscribers_.erase(typeIndex);
+        Channel* channel = FindChannel(typeIndex);
+        if (!channel) {
+            return;
+        }
+        if (channel->keyedHashes.count(id)) {
+            RemoveKeyedSubscriber(*channel, id);
+            return;
+        }
+        const SubscriberList* current = channel->subscribers.load();
+        if (!current) {
+            return;
+        }
+        auto* subscribers = new SubscriberList();
+        subscribers->reserve(current->size());
+        for (const auto& subscriber : *current) {
+            if (subscriber.id != id) {
+                subscribers->push_back(subscriber);
             }
         }
+        if (subscribers->size() == current->size()) {
+            delete subscribers;
+            return;
+        }
+        if (subscribers->empty()) {
+            delete subscribers;
+            subscribers = nullptr;
+        }
+        ReplaceSubscribers(*channel, subscribers);
     }
 
 
     /**
      * @brief 发布指定类型的事件，通知所有订阅者。
      * 
+     * 无锁且不分配内存：登记为读者后读取订阅者快照并逐个回调。
+     * 回调中可以安全地发布事件或增删订阅，本次发布仍使用进入时的快照。
+     * 
      * @tparam EventType 事件类型，支持泛型。
      * @param event 事件实例的引用。
      */
     template<typename EventType>
     void Publish(const EventType& event) {
-        std::vector<Subscriber> subscribersCopy;
+        ReaderGuard guard(*this);
+        Channel* channel = FindChannel<EventType>();
+        if (!channel) {
+            return;
+        }
+        const SubscriberList* subscribers = channel->subscribers.load();
+        const size_t broadcastCount = subscribers ? subscribers->size() : 0;
+        size_t next = 0;
+
+        if constexpr (HasEventKey<EventType>::value) {
+            // 只访问键所在的桶，并与普通订阅者按优先级归并调用
+            const KeyedTable* keyed = channel->keyed.load();
+            if (keyed) {
+                const std::string& key = event.EventKey();
+                size_t hash = std::hash<std::string>{}(key);
+                const KeyedList* bucket = keyed->buckets[hash & (keyed->buckets.size() - 1)].load();
+                if (bucket) {
+                    for (const auto& entry : *bucket) {
+                        if (entry.hash != hash || entry.key != key) continue;
+                        while (next < broadcastCount && (*subscribers)[next].priority <= entry.subscriber.priority) {
+                            (*subscribers)[next++].Invoke(&event);
+                        }
+                        entry.subscriber.Invoke(&event);
+                    }
+                }
+            }
+        }
+
+        while (next < broadcastCount) {
+            (*subscribers)[next++].Invoke(&event);
+        }
+    }
+
+    /**
+     * @brief 将事件追加到对应类型的队列，等待下一次 DispatchQueued 统一分发。
+     * 
+     * 若事件类型提供 EventKey() 成员，同一帧内键相同的事件会被合并为一次分发，
+     * 保留首次入队的位置与最后一次的内容。可在任意线程调用。
+     * 
+     * @tparam EventType 事件类型，支持泛型。
+     * @param event 事件实例。
+     */
+    template<typename EventType>
+    void Enqueue(EventType event) {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        auto typeIndex = std::type_index(typeid(EventType));
+        auto& slot = queues_[typeIndex];
+        if (!slot) {
+            slot = std::make_unique<TypedQueue<EventType>>();
+        }
+        auto& queue = static_cast<TypedQueue<EventType>&>(*slot);
+        if (queue.pending.Empty()) {
+            pendingQueues_.push_back(&queue);
+        }
+        queueStats_.enqueued++;
+        if (queue.Push(std::move(event))) {
+            queueStats_.coalesced++;
+        }
+    }
+
+    /**
+     * @brief 分发所有排队事件，通常每帧调用一次。
+     * 
+     * 按类型首次入队的顺序依次分发，同一类型内保持入队顺序。分发期间新入队的事件
+     * 留到下一次调用，避免回调中再次入队造成无限循环。
+     * 
+     * @return size_t 本次分发的事件数量。
+     */
+    size_t DispatchQueued() {
+        std::vector<QueueBase*> queues;
+        QueueStats stats;
         {
-            std::lock_guard<std::mutex> lock(mutex_);
-            auto typeIndex = std::type_index(typeid(EventType));
-            auto it = subscribers_.find(typeIndex);
-            if (it != subscribers_.end()) {
-                subscribersCopy = it->second; // 复制当前订阅者列表
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            queues.swap(dispatchingQueues_);
+            queues.swap(pendingQueues_);
+            for (auto queue : queues) {
+                queue->BeginDispatch();
             }
+            stats = queueStats_;
+            queueStats_ = QueueStats{};
         }
-        // 在锁外执行回调
-        for (const auto& subscriber : subscribersCopy) {
-            subscriber.callback(&event);
+
+        for (auto queue : queues) {
+            stats.dispatched += queue->Dispatch(*this);
         }
+
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        lastQueueStats_ = stats;
+        // 归还容器以复用容量，稳定状态下每帧分发不产生堆分配
+        queues.clear();
+        dispatchingQueues_.swap(queues);
+        return stats.dispatched;
+    }
+
+    /**
+     * @brief 获取最近一次 DispatchQueued 对应帧的排队统计。
+     */
+    QueueStats GetQueueStats() const {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        return lastQueueStats_;
     }
 
 private:
+    /**
+     * @brief 按需扩容的环形缓冲区，清空后保留容量供下一帧复用。
+     */
+    template<typename T>
+    class RingBuffer {
+    public:
+        bool Empty() const { return count_ == 0; }
+        size_t Size() const { return count_; }
+
+        void Push(T value) {
+            if (count_ == storage_.size()) {
+                Grow();
+            }
+            storage_[(head_ + count_) % storage_.size()] = std::move(value);
+            count_++;
+        }
+
+        T& At(size_t index) { return storage_[(head_ + index) % storage_.size()]; }
+
+        T Pop() {
+            T value = std::move(storage_[head_]);
+            head_ = (head_ + 1) % storage_.size();
+            count_--;
+            return value;
+        }
+
+        void Swap(RingBuffer& other) {
+            storage_.swap(other.storage_);
+            std::swap(head_, other.head_);
+            std::swap(count_, other.count_);
+        }
+
+    private:
+        void Grow() {
+            std::vector<T> storage(std::max<size_t>(16, storage_.size() * 2));
+            for (size_t i = 0; i < count_; ++i) {
+                storage[i] = std::move(At(i));
+            }
+            storage_.swap(storage);
+            head_ = 0;
+        }
+
+        std::vector<T> storage_;
+        size_t head_ = 0;
+        size_t count_ = 0;
+    };
+
+    template<typename T, typename = void>
+    struct HasEventKey : std::false_type {};
+
+    template<typename T>
+    struct HasEventKey<T, std::void_t<decltype(std::declval<const T&>().EventKey())>> : std::true_type {};
+
+    /**
+     * @brief 类型擦除的事件队列基类，供 DispatchQueued 统一处理。
+     */
+    struct QueueBase {
+        virtual ~QueueBase() = default;
+        virtual void BeginDispatch() = 0;          // 需持有 queueMutex_，将待分发事件移入分发缓冲
+        virtual size_t Dispatch(EventBus& bus) = 0; // 在锁外逐个发布分发缓冲中的事件
+    };
+
+    template<typename EventType>
+    struct TypedQueue : QueueBase {
+        RingBuffer<EventType> pending;     // 本帧入队的事件
+        RingBuffer<EventType> dispatching; // 正在分发的事件
+        std::unordered_map<std::string, size_t> slots; // 合并键到 pending 中位置的映射
+
+        /**
+         * @brief 追加事件，若与已有事件合并则返回 true。
+         */
+        bool Push(EventType event) {
+            if constexpr (HasEventKey<EventType>::value) {
+                auto [it, inserted] = slots.try_emplace(std::string(event.EventKey()), pending.Size());
+                if (!inserted) {
+                    pending.At(it->second) = std::move(event);
+                    return true;
+                }
+            }
+            pending.Push(std::move(event));
+            return false;
+        }
+
+        void BeginDispatch() override {
+            pending.Swap(dispatching);
+            slots.clear();
+        }
+
+        size_t Dispatch(EventBus& bus) override {
+            size_t count = 0;
+            while (!dispatching.Empty()) {
+                bus.Publish(dispatching.Pop());
+                count++;
+            }
+            return count;
+        }
+    };
+
     /**
      * @brief 订阅者结构体，包含 ID 和回调函数。
+     * 
+     * 回调以原始类型保存，invoke 是针对 (事件类型, 回调类型) 实例化的跳板函数，
+     * 回调体可在其中内联，避免 std::function 的多层类型擦除。
      */
     struct Subscriber {
         SubscriberId id;                    // 订阅者唯一标识
-        std::function<void(const void*)> callback;  // 回调函数，接收事件指针
+        void (*invoke)(void* callback, const void* event);  // 类型化调用跳板
+        std::shared_ptr<void> callback;     // 回调对象，快照复制时共享
         Priority priority;
+
+        void Invoke(const void* event) const { invoke(callback.get(), event); }
     };
 
-    std::mutex mutex_;  // 互斥锁，确保线程安全
-    std::map<std::type_index, std::vector<Subscriber>> subscribers_;  // 事件类型到订阅者列表的映射
+    using SubscriberList = std::vector<Subscriber>;
+
+    /**
+     * @brief 键控订阅者，保存键及其哈希以便在桶内快速过滤冲突项。
+     */
+    struct KeyedSubscriber {
+        size_t hash;
+        std::string key;
+        Subscriber subscriber;
+    };
+
+    using KeyedList = std::vector<KeyedSubscriber>;
+
+    /**
+     * @brief 键控订阅的哈希表，桶数量为 2 的幂，每个桶指向不可变的订阅者列表。
+     */
+    struct KeyedTable {
+        explicit KeyedTable(size_t bucketCount) : buckets(bucketCount) {}
+        ~KeyedTable() {
+            for (auto& bucket : buckets) {
+                delete bucket.load();
+            }
+        }
+        std::vector<std::atomic<const KeyedList*>> buckets;
+    };
+
+    /**
+     * @brief 单个事件类型的通道，持有当前订阅者快照。通道创建后直到 EventBus 析构前不会释放。
+     */
+    struct Channel {
+        ~Channel() {
+            delete subscribers.load();
+            delete keyed.load();
+        }
+        std::atomic<const SubscriberList*> subscribers{nullptr};
+        std::atomic<KeyedTable*> keyed{nullptr};
+        size_t keyedCount = 0;                                  // 键控订阅者数量，仅写者访问
+        std::unordered_map<SubscriberId, size_t> keyedHashes;   // 键控订阅者 ID 到键哈希，仅写者访问
+    };
+
+    static constexpr size_t kInitialKeyedBuckets = 16;
+
+    using ChannelTable = std::unordered_map<std::type_index, Channel*>;
+
+    /**
+     * @brief 调用类型化回调并捕获其中的异常。
+     */
+    template<typename EventType, typename Callback>
+    static void InvokeCallback(void* callback, const void* event) {
+        try {
+            (*static_cast<Callback*>(callback))(*static_cast<const EventType*>(event));
+        } catch (const std::exception& e) {
+            std::cerr << "Error in event callback for type " 
+                      << typeid(EventType).name() << ": " << e.what() << std::endl;
+        }
+    }
+
+    /**
+     * @brief 保存回调对象并绑定对应的调用跳板。
+     */
+    template<typename EventType, typename F>
+    static Subscriber MakeSubscriber(SubscriberId id, F&& callback, Priority priority) {
+        using Callback = std::decay_t<F>;
+        static_assert(std::is_invocable_v<Callback&, const EventType&>, "EventBus: callback must accept const EventType&");
+        return Subscriber{
+            id,
+            &InvokeCallback<EventType, Callback>,
+            std::make_shared<Callback>(std::forward<F>(callback)),
+            priority
+        };
+    }
+
+    /**
+     * @brief Publish 期间在当前纪元登记为读者，写者据此判断旧快照能否释放。
+     *
+     * 读取纪元与登记之间纪元可能已被推进，登记后再次确认纪元未变，否则撤销并重新登记，
+     * 因此登记成功的读者一定能看到该纪元开始前发布的快照。读者退出使所在纪元清空且有
+     * 待释放的快照时尝试回收，写操作停止后旧快照也不会一直滞留。
+     */
+    struct ReaderGuard {
+        explicit ReaderGuard(EventBus& bus) : bus(bus) {
+            for (;;) {
+                uint64_t epoch = bus.epoch_.load();
+                readers = &bus.epochReaders_[epoch & 1];
+                readers->fetch_add(1);
+                if (bus.epoch_.load() == epoch) break;
+                readers->fetch_sub(1);
+            }
+        }
+        ~ReaderGuard() {
+            if (readers->fetch_sub(1) == 1 && bus.retiredCount_.load() > 0) {
+                bus.TryReclaimRetired();
+            }
+        }
+        EventBus& bus;
+        std::atomic<size_t>* readers = nullptr;
+    };
+
+    /**
+     * @brief 无锁查找事件类型对应的通道，不存在时返回 nullptr。
+     */
+    Channel* FindChannel(std::type_index typeIndex) const {
+        const ChannelTable* table = channelTable_.load();
+        if (!table) {
+            return nullptr;
+        }
+        auto it = table->find(typeIndex);
+        return it != table->end() ? it->second : nullptr;
+    }
+
+    /**
+     * @brief 无锁定位事件类型对应的通道：注册事件按编译期 ID 直接索引，其余事件查表。
+     */
+    template<typename EventType>
+    Channel* FindChannel() {
+        constexpr int typeId = EventTypeId<EventType>::value;
+        if constexpr (typeId >= 0) {
+            static_assert(typeId < static_cast<int>(kMaxEventTypes), "EventBus: event type id exceeds kMaxEventTypes");
+            return &registeredChannels_[typeId];
+        } else {
+            return FindChannel(std::type_index(typeid(EventType)));
+        }
+    }
+
+    /**
+     * @brief 获取事件类型对应的通道，必要时创建，需持有 mutex_。
+     * 
+     * 注册事件使用预分配的数组通道，但仍登记到通道表中，供按 std::type_index 取消订阅时查找。
+     */
+    template<typename EventType>
+    Channel& GetOrCreateChannel() {
+        constexpr int typeId = EventTypeId<EventType>::value;
+        if constexpr (typeId >= 0) {
+            return GetOrCreateChannel(std::type_index(typeid(EventType)), &registeredChannels_[typeId]);
+        } else {
+            return GetOrCreateChannel(std::type_index(typeid(EventType)), nullptr);
+        }
+    }
+
+    /**
+     * @brief 查找或创建通道，需持有 mutex_。通道表同样以写时复制方式替换。
+     * 
+     * @param preallocated 注册事件的数组通道；为 nullptr 时新建通道。
+     */
+    Channel& GetOrCreateChannel(std::type_index typeIndex, Channel* preallocated) {
+        if (Channel* channel = FindChannel(typeIndex)) {
+            return *channel;
+        }
+        Channel* channel = preallocated;
+        if (!channel) {
+            channels_.push_back(std::make_unique<Channel>());
+            channel = channels_.back().get();
+        }
+
+        const ChannelTable* current = channelTable_.load();
+        auto* table = current ? new ChannelTable(*current) : new ChannelTable();
+        (*table)[typeIndex] = channel;
+        channelTable_.store(table);
+        Retire(current);
+        ReclaimRetired();
+        return *channel;
+    }
+
+    /**
+     * @brief 原子替换通道的订阅者快照并回收旧快照，需持有 mutex_。
+     */
+    void ReplaceSubscribers(Channel& channel, const SubscriberList* subscribers) {
+        Retire(channel.subscribers.exchange(subscribers));
+        ReclaimRetired();
+    }
+
+    /**
+     * @brief 添加键控订阅者，需持有 mutex_。订阅者数量超过桶数量时将哈希表扩容一倍。
+     */
+    void AddKeyedSubscriber(Channel& channel, KeyedSubscriber entry) {
+        KeyedTable* table = channel.keyed.load();
+        if (!table || channel.keyedCount + 1 > table->buckets.size()) {
+            table = RehashKeyed(channel, table ? table->buckets.size() * 2 : kInitialKeyedBuckets);
+        }
+
+        auto& bucket = table->buckets[entry.hash & (table->buckets.size() - 1)];
+        const KeyedList* current = bucket.load();
+        auto* list = current ? new KeyedList(*current) : new KeyedList();
+        // 桶内按优先级保持有序，同优先级按订阅顺序
+        auto position = std::upper_bound(list->begin(), list->end(), entry.subscriber.priority,
+            [](Priority priority, const KeyedSubscriber& other) { return priority < other.subscriber.priority; });
+        channel.keyedHashes[entry.subscriber.id] = entry.hash;
+        list->insert(position, std::move(entry));
+        Retire(bucket.exchange(list));
+        channel.keyedCount++;
+        ReclaimRetired();
+    }
+
+    /**
+     * @brief 移除键控订阅者，需持有 mutex_。
+     */
+    void RemoveKeyedSubscriber(Channel& channel, SubscriberId id) {
+        auto it = channel.keyedHashes.find(id);
+        KeyedTable* table = channel.keyed.load();
+        auto& bucket = table->buckets[it->second & (table->buckets.size() - 1)];
+        channel.keyedHashes.erase(it);
+
+        const KeyedList* current = bucket.load();
+        auto* list = new KeyedList();
+        list->reserve(current->size());
+        for (const auto& entry : *current) {
+            if (entry.subscriber.id != id) {
+                list->push_back(entry);
+            }
+        }
+        if (list->empty()) {
+            delete list;
+            list = nullptr;
+        }
+        Retire(bucket.exchange(list));
+        channel.keyedCount--;
+        ReclaimRetired();
+    }
+
+    /**
+     * @brief 以新的桶数量重建键控哈希表并替换旧表，需持有 mutex_。
+     */
+    KeyedTable* RehashKeyed(Channel& channel, size_t bucketCount) {
+        std::vector<KeyedList> lists(bucketCount);
+        KeyedTable* current = channel.keyed.load();
+        if (current) {
+            for (auto& bucket : current->buckets) {
+                if (const KeyedList* list = bucket.load()) {
+                    for (const auto& entry : *list) {
+                        lists[entry.hash & (bucketCount - 1)].push_back(entry);
+                    }
+                }
+            }
+        }
+
+        auto* table = new KeyedTable(bucketCount);
+        for (size_t i = 0; i < bucketCount; ++i) {
+            if (!lists[i].empty()) {
+                std::stable_sort(lists[i].begin(), lists[i].end(), [](const KeyedSubscriber& a, const KeyedSubscriber& b) {
+                    return a.subscriber.priority < b.subscriber.priority;
+                });
+                table->buckets[i].store(new KeyedList(std::move(lists[i])));
+            }
+        }
+        channel.keyed.store(table);
+        Retire(current);
+        return table;
+    }
+
+    /**
+     * @brief 已被替换的快照及其退役时的纪元。
+     */
+    struct RetiredSnapshot {
+        uint64_t epoch;
+        std::shared_ptr<const void> snapshot;
+    };
+
+    /**
+     * @brief 登记已被替换的快照，等待 ReclaimRetired 释放，需持有 mutex_。
+     */
+    template<typename T>
+    void Retire(const T* snapshot) {
+        if (snapshot) {
+            retired_.push_back(RetiredSnapshot{epoch_.load(), std::shared_ptr<const void>(snapshot)});
+        }
+    }
+
+    /**
+     * @brief 释放所有读者都已不可能持有的快照并推进纪元，需持有 mutex_。
+     *
+     * 纪元只在上一个纪元的读者全部退出后推进，因此当前纪元为 E 且 E - 1 的读者计数为零时，
+     * 纪元早于 E 的读者均已结束，E 之前退役的快照可以释放。每次最多推进两个纪元，
+     * 使刚退役的快照在没有并发读者时立即释放；仍有读者的快照推迟到之后的写操作或读者退出时。
+     */
+    void ReclaimRetired() {
+        for (int step = 0; step < 2 && !retired_.empty(); ++step) {
+            uint64_t epoch = epoch_.load();
+            if (epochReaders_[(epoch + 1) & 1].load() != 0) {
+                break;
+            }
+            auto expired = std::find_if(retired_.begin(), retired_.end(),
+                                        [epoch](const RetiredSnapshot& retired) { return retired.epoch >= epoch; });
+            retired_.erase(retired_.begin(), expired);
+            epoch_.store(epoch + 1);
+        }
+        retiredCount_.store(retired_.size());
+    }
+
+    /**
+     * @brief 读者退出时的回收入口，写者正持有 mutex_ 时跳过，由写者自己回收。
+     */
+    void TryReclaimRetired() {
+        std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+        if (lock.owns_lock()) {
+            ReclaimRetired();
+        }
+    }
+
+    std::mutex mutex_;  // 互斥锁，串行化订阅与取消订阅
+    std::atomic<const ChannelTable*> channelTable_{nullptr};  // 事件类型到通道的映射快照
+    std::array<Channel, kMaxEventTypes> registeredChannels_;  // 注册事件的通道，按编译期 ID 索引
+    std::vector<std::unique_ptr<Channel>> channels_;          // 未注册事件的通道
+    std::vector<RetiredSnapshot> retired_;  // 等待释放的快照（订阅者列表、通道表、键控桶与哈希表），按纪元递增
+    std::atomic<size_t> retiredCount_{0};   // retired_ 的大小，供读者退出时无锁判断是否需要回收
+    std::atomic<uint64_t> epoch_{0};        // 当前读者纪元，由写者在回收时推进
+    std::array<std::atomic<size_t>, 2> epochReaders_{};  // 按纪元奇偶分槽的读者数量
     std::atomic<size_t> nextId_{0};  // 原子变量，用于生成唯一的订阅者 ID
+
+    mutable std::mutex queueMutex_;  // 保护排队模式的队列与统计
+    std::unordered_map<std::type_index, std::unique_ptr<QueueBase>> queues_;  // 事件类型到队列的映射
+    std::vector<QueueBase*> pendingQueues_;      // 本帧有事件入队的队列，按首次入队顺序排列
+    std::vector<QueueBase*> dispatchingQueues_;  // 复用的分发列表容器
+    QueueStats queueStats_;      // 当前帧累计的统计
+    QueueStats lastQueueStats_;  // 最近一次分发对应帧的统计
 };
 
 #endif // EVENTBUS_H
\ No newline at end of file
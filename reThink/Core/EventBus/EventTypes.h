@@ -23,6 +23,7 @@ struct ModelData {
     std::vector<unsigned int> indices; // 索引数据 (用于网格渲染)
     std::string parentUUID;        // 父模型的 UUID (支持层级结构，若无则为空)
     std::vector<glm::vec3> normals; // 顶点法线数据 (用于法线贴图和阴影计算)
+    std::vector<glm::mat4> instanceTransforms; // 实例变换 (非空时网格按实例化方式绘制，每个实例一个变换)
 };
 
 struct KeyframeData {
@@ -84,6 +85,7 @@ namespace Events {
         std::string modelUUID;
         glm::mat4 transform; // 变换矩阵
         static constexpr EventBus::Priority priority = EventBus::Priority::High; // 高优先级，影响渲染
+        const std::string& EventKey() const { return modelUUID; } // 事件键：排队模式按模型合并，键控订阅按模型投递
     };
 
 /*    // 着色器编译完成事件
@@ -158,6 +160,7 @@ namespace Events {
         float shininess;             // 镜面高光系数
         std::string textureUUID;     // 纹理 UUID
         static constexpr EventBus::Priority priority = EventBus::Priority::High; // 高优先级，影响渲染
+        const std::string& EventKey() const { return materialUUID; } // 事件键：排队模式按材质合并，键控订阅按材质投递
     };
 
     // 材质删除事件
@@ -282,30 +285,45 @@ namespace Events {
     
     // 程序化生成开始事件
     struct ProceduralGenerationStartedEvent {
+        uint64_t jobId = 0;    // 生成任务 ID
         static constexpr EventBus::Priority priority = EventBus::Priority::Normal; // 普通优先级，生成开始不需实时
     };
 
     // 进度更新事件
     struct ProgressUpdateEvent {
         float progress; // 进度值（0.0 到 1.0）
+        uint64_t jobId = 0; // 生成任务 ID
         static constexpr EventBus::Priority priority = EventBus::Priority::Low; // 低优先级，进度更新不紧急
     };
 
+    // 程序化生成分块完成事件：生成器每完成一块即输出该块的网格，同一块重新求解后以相同 UUID 再次发送。
+    // 实例化输出时每块为一种瓦片的网格及其全部实例变换
+    struct ProceduralChunkReadyEvent {
+        ModelData chunkData;   // 该块的网格，parentUUID 为本次生成结果的 UUID
+        size_t chunkIndex;     // 块索引
+        size_t chunkCount;     // 本次生成的块总数
+        uint64_t jobId = 0;    // 生成任务 ID
+        static constexpr EventBus::Priority priority = EventBus::Priority::Normal; // 普通优先级
+    };
+
     // 程序化生成完成事件
     struct ProceduralGenerationCompletedEvent {
         bool success;              // 是否成功
         std::string errorMessage;  // 若失败，携带错误信息
         ModelData modelData;       // 生成的模型数据（成功时有效）
+        uint64_t jobId = 0;        // 生成任务 ID
         static constexpr EventBus::Priority priority = EventBus::Priority::Normal; // 普通优先级
     };
 
     // 请求取消生成事件
     struct RequestGenerationCancelEvent {
+        uint64_t jobId = 0;    // 要取消的任务 ID，为 0 时取消全部任务
         static constexpr EventBus::Priority priority = EventBus::Priority::Normal; // 普通优先级，取消请求不紧急
     };
 
     // 程序化生成停止事件
     struct ProceduralGenerationStoppedEvent {
+        uint64_t jobId = 0;    // 生成任务 ID
         static constexpr EventBus::Priority priority = EventBus::Priority::Normal; // 普通优先级，停止不需实时
     };
 
@@ -371,4 +389,64 @@ namespace Events {
 } // namespace Events
 } // namespace MyRenderer
 
+/**
+ * @brief 编译期事件注册表。列表中的事件按顺序获得稠密 ID，EventBus 据此按数组下标分发。
+ * 新增事件时追加到列表末尾即可。
+ */
+using RegisteredEventTypes = EventTypeList<
+    MyRenderer::Events::SceneLightUpdatedEvent,
+    MyRenderer::Events::ModelSelectionChangedEvent,
+    MyRenderer::Events::OperationModeChangedEvent,
+    MyRenderer::Events::ModelTransformedEvent,
+    MyRenderer::Events::AnimationFrameChangedEvent,
+    MyRenderer::Events::ProjectOpenedEvent,
+    MyRenderer::Events::KeyframeAddedEvent,
+    MyRenderer::Events::LayoutChangeEvent,
+    MyRenderer::Events::OpenFileEvent,
+    MyRenderer::Events::ViewportFocusEvent,
+    MyRenderer::Events::ModelLoadedEvent,
+    MyRenderer::Events::ModelDeletedEvent,
+    MyRenderer::Events::MaterialCreatedEvent,
+    MyRenderer::Events::MaterialUpdatedEvent,
+    MyRenderer::Events::MaterialDeletedEvent,
+    MyRenderer::Events::RequestMaterialCreationEvent,
+    MyRenderer::Events::RequestTextureLoadEvent,
+    MyRenderer::Events::TextureLoadedEvent,
+    MyRenderer::Events::TextureDeletedEvent,
+    MyRenderer::Events::AnimationDataLoadedEvent,
+    MyRenderer::Events::RequestAnimationDataLoadEvent,
+    MyRenderer::Events::RequestAnimationDataSaveEvent,
+    MyRenderer::Events::AnimationPlaybackControlEvent,
+    MyRenderer::Events::AnimationUpdatedEvent,
+    MyRenderer::Events::AnimationPlaybackStartedEvent,
+    MyRenderer::Events::AnimationPlaybackStoppedEvent,
+    MyRenderer::Events::KeyframeModifiedEvent,
+    MyRenderer::Events::KeyframeDeletedEvent,
+    MyRenderer::Events::RequestAnimationFrameChangeEvent,
+    MyRenderer::Events::PushUndoOperationEvent,
+    MyRenderer::Events::UndoRedoEvent,
+    MyRenderer::Events::RequestModelCreatedEvent,
+    MyRenderer::Events::HierarchyUpdateEvent,
+    MyRenderer::Events::ProceduralGenerationStartedEvent,
+    MyRenderer::Events::ProgressUpdateEvent,
+    MyRenderer::Events::ProceduralChunkReadyEvent,
+    MyRenderer::Events::ProceduralGenerationCompletedEvent,
+    MyRenderer::Events::RequestGenerationCancelEvent,
+    MyRenderer::Events::ProceduralGenerationStoppedEvent,
+    MyRenderer::Events::ProjectSavedEvent,
+    MyRenderer::Events::ProjectLoadFailedEvent,
+    MyRenderer::Events::TransformToolEvent,
+    MyRenderer::Events::RequestNewProjectEvent,
+    MyRenderer::Events::RequestOpenProjectEvent,
+    MyRenderer::Events::RequestSaveProjectEvent,
+    MyRenderer::Events::ModelCreatedEvent,
+    MyRenderer::Events::TextureUpdatedEvent
+>;
+
+static_assert(RegisteredEventTypes::size <= EventBus::kMaxEventTypes, "EventTypes: too many registered events, raise EventBus::kMaxEventTypes");
+
+template<typename T>
+struct EventTypeId<T, std::enable_if_t<(RegisteredEventTypes::IndexOf<T>() >= 0)>>
+    : std::integral_constant<int, RegisteredEventTypes::IndexOf<T>()> {};
+
 #endif // EVENT_TYPES_H
@@ -2,15 +2,31 @@
 #include <stdexcept>
 #include <sstream>
 
-ThreadPool::ThreadPool(size_t threadCount) 
-    : stop(false), activeTasks(0) {
+namespace {
+    // 当前线程所属的线程池及其工作线程下标，用于让工作线程内部提交的任务进入自己的本地队列
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local size_t currentWorkerIndex = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadCount, SchedulingMode mode)
+    : mode(mode), nextQueue(0), queuedTasks(0), sleepingWorkers(0), completionWaiters(0),
+      tasksExecuted(0), workerWakeups(0), steals(0), completionNotifications(0),
+      stop(false), activeTasks(0) {
     if (threadCount == 0) {
         throw std::invalid_argument("ThreadPool: threadCount must be greater than 0");
     }
 
+    // 工作窃取模式下为每个线程创建本地队列，必须在线程启动前完成
+    if (mode == SchedulingMode::WorkStealing) {
+        localQueues.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            localQueues.push_back(std::make_unique<WorkerQueue>());
+        }
+    }
+
     // 初始化工作线程
     for (size_t i = 0; i < threadCount; ++i) {
-        workers.emplace_back(&ThreadPool::WorkerThread, this);
+        workers.emplace_back(&ThreadPool::WorkerThread, this, i);
     }
 }
 
@@ -19,7 +35,7 @@ ThreadPool::~ThreadPool() {
         std::unique_lock<std::mutex> lock(queueMutex);
         stop = true;
     }
-    
+
     // 通知所有线程退出
     condition.notify_all();
 
@@ -32,15 +48,13 @@ ThreadPool::~ThreadPool() {
 }
 
 void ThreadPool::WaitAll() {
-    // 等待所有任务完成
-    while (true) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        if (tasks.empty() && activeTasks == 0) {
-            break;
-        }
-        lock.unlock();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // 短暂休眠以减少忙等待
-    }
+    // 等待所有任务完成；只有活跃任务数归零时才会收到通知
+    std::unique_lock<std::mutex> lock(queueMutex);
+    completionWaiters++;
+    completionCondition.wait(lock, [this] {
+        return tasks.empty() && queuedTasks.load() == 0 && activeTasks.load() == 0;
+    });
+    completionWaiters--;
 }
 
 void ThreadPool::SetErrorCallback(std::function<void(const std::string&)> callback) {
@@ -50,20 +64,187 @@ void ThreadPool::SetErrorCallback(std::function<void(const std::string&)> callba
 
 size_t ThreadPool::GetPendingTaskCount() const {
     std::lock_guard<std::mutex> lock(queueMutex);
-    return tasks.size() + activeTasks;
+    return tasks.size() + queuedTasks + activeTasks;
+}
+
+ThreadPool::Stats ThreadPool::GetStats() const {
+    Stats stats;
+    stats.tasksExecuted = tasksExecuted.load();
+    stats.workerWakeups = workerWakeups.load();
+    stats.steals = steals.load();
+    stats.completionNotifications = completionNotifications.load();
+    return stats;
+}
+
+bool ThreadPool::IsWorkerThread() const {
+    return currentPool == this;
+}
+
+size_t ThreadPool::ResolveGrainSize(size_t count, size_t grainSize) const {
+    if (grainSize > 0) {
+        return grainSize;
+    }
+    size_t targetChunks = workers.size() * kChunksPerThread;
+    return std::max<size_t>(1, (count + targetChunks - 1) / targetChunks);
+}
+
+size_t ThreadPool::LaneForPriority(int priority) {
+    if (priority > 0) return 0;
+    if (priority == 0) return 1;
+    return 2;
+}
+
+void ThreadPool::Submit(std::function<void()> taskFunction, int priority) {
+    if (stop) {
+        throw std::runtime_error("ThreadPool: Cannot enqueue task after shutdown");
+    }
+
+    if (mode == SchedulingMode::SharedQueue) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            if (stop) {
+                throw std::runtime_error("ThreadPool: Cannot enqueue task after shutdown");
+            }
+
+            // 放入优先级队列
+            tasks.emplace(std::move(taskFunction), priority);
+        }
+
+        // 通知一个等待的工作线程
+        condition.notify_one();
+        return;
+    }
+
+    // 工作线程内部提交的任务进入自己的本地队列，外部线程提交的任务轮询分发
+    size_t target = (currentPool == this)
+        ? currentWorkerIndex
+        : nextQueue.fetch_add(1, std::memory_order_relaxed) % localQueues.size();
+
+    {
+        // 在队列锁内先计数再入队，窃取者取走任务时计数一定已经包含它，不会减到零以下
+        WorkerQueue& queue = *localQueues[target];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queuedTasks.fetch_add(1);
+        queue.lanes[LaneForPriority(priority)].push_back(std::move(taskFunction));
+    }
+
+    // 只有存在休眠线程时才需要触碰 queueMutex；先加锁再通知，保证不会丢失唤醒
+    if (sleepingWorkers.load() > 0) {
+        { std::lock_guard<std::mutex> lock(queueMutex); }
+        condition.notify_one();
+    }
+}
+
+ThreadPool::Task<void> ThreadPool::WhenAll(const std::vector<TaskHandle>& tasks, int priority) {
+    return Async([]() {}, tasks, priority);
+}
+
+void ThreadPool::AddDependency(const std::shared_ptr<TaskNode>& before, const std::shared_ptr<TaskNode>& after) {
+    std::lock_guard<std::mutex> lock(before->mutex);
+    if (before->finished) {
+        return;
+    }
+    after->pendingDependencies.fetch_add(1);
+    before->successors.push_back(after);
+}
+
+void ThreadPool::StartNode(const std::shared_ptr<TaskNode>& node, const std::vector<TaskHandle>& dependencies) {
+    for (const auto& dependency : dependencies) {
+        if (dependency.node) {
+            AddDependency(dependency.node, node);
+        }
+    }
+    // 释放创建者持有的那一份依赖，若依赖均已完成则立即提交
+    ReleaseNode(node);
+}
+
+void ThreadPool::ReleaseNode(const std::shared_ptr<TaskNode>& node) {
+    if (node->pendingDependencies.fetch_sub(1) == 1) {
+        Submit([this, node]() { RunNode(node); }, node->priority);
+    }
+}
+
+void ThreadPool::RunNode(const std::shared_ptr<TaskNode>& node) {
+    // work 由 packaged_task 包装，异常会保存在对应的 future 中，不会中断后继的释放
+    node->work();
+    node->work = nullptr;
+
+    std::vector<std::shared_ptr<TaskNode>> successors;
+    {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        node->finished = true;
+        successors.swap(node->successors);
+    }
+    for (const auto& successor : successors) {
+        ReleaseNode(successor);
+    }
+}
+
+bool ThreadPool::TryAcquireTask(size_t index, std::function<void()>& task) {
+    const size_t queueCount = localQueues.size();
+
+    // 取出任务时持有队列锁，先计入 activeTasks 再减少 queuedTasks，
+    // 避免 WaitAll 观察到两者同时为零的瞬间；未取到任务时不触碰 activeTasks
+    auto take = [this, &task](std::deque<std::function<void()>>& lane, bool back) {
+        task = std::move(back ? lane.back() : lane.front());
+        if (back) lane.pop_back(); else lane.pop_front();
+        activeTasks++;
+        queuedTasks.fetch_sub(1);
+    };
+
+    // 按优先级从高到低：先查本地队列，再依次窃取其他线程同一通道的任务
+    for (size_t lane = 0; lane < kPriorityLanes; ++lane) {
+        {
+            WorkerQueue& own = *localQueues[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.lanes[lane].empty()) {
+                take(own.lanes[lane], true);
+                return true;
+            }
+        }
+
+        // 先用 try_lock 跳过繁忙的队列；有队列因竞争被跳过时再逐个阻塞加锁检查一遍，
+        // 否则 queuedTasks 非零时工作线程会在加锁失败与重试之间空转
+        bool contended = false;
+        for (size_t offset = 1; offset < queueCount; ++offset) {
+            WorkerQueue& victim = *localQueues[(index + offset) % queueCount];
+            std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+            if (!lock.owns_lock()) {
+                contended = true;
+            } else if (!victim.lanes[lane].empty()) {
+                take(victim.lanes[lane], false);
+                steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (size_t offset = 1; contended && offset < queueCount; ++offset) {
+            WorkerQueue& victim = *localQueues[(index + offset) % queueCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.lanes[lane].empty()) {
+                take(victim.lanes[lane], false);
+                steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
-void ThreadPool::WorkerThread() {
+void ThreadPool::WorkerThread(size_t index) {
+    currentPool = this;
+    currentWorkerIndex = index;
+
     while (true) {
         std::function<void()> task;
 
-        {
+        if (mode == SchedulingMode::SharedQueue) {
             std::unique_lock<std::mutex> lock(queueMutex);
 
             // 等待任务或停止信号
-            condition.wait(lock, [this] { 
-                return stop || !tasks.empty(); 
-            });
+            while (!stop && tasks.empty()) {
+                condition.wait(lock);
+                workerWakeups.fetch_add(1, std::memory_order_relaxed);
+            }
 
             // 如果停止且任务队列为空，退出线程
             if (stop && tasks.empty()) {
@@ -74,31 +255,145 @@ void ThreadPool::WorkerThread() {
             task = std::move(tasks.top().taskFunction);
             tasks.pop();
             activeTasks++;
+        } else {
+            // 在锁外尝试获取任务，取到时已计入 activeTasks；未取到时直接休眠，不发出完成通知
+            if (!TryAcquireTask(index, task)) {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                sleepingWorkers++;
+                while (!stop && queuedTasks.load() == 0) {
+                    condition.wait(lock);
+                    workerWakeups.fetch_add(1, std::memory_order_relaxed);
+                }
+                sleepingWorkers--;
+
+                if (stop && queuedTasks.load() == 0) {
+                    return;
+                }
+                continue;
+            }
+        }
+
+        ExecuteTask(task);
+    }
+}
+
+void ThreadPool::ExecuteTask(std::function<void()>& task) {
+    // 执行任务
+    try {
+        task();
+    } catch (const std::exception& e) {
+        // 捕获任务执行中的异常，调用错误回调
+        std::string errorMsg = std::string("ThreadPool task failed: ") + e.what();
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (errorCallback) {
+            errorCallback(errorMsg);
+        }
+    } catch (...) {
+        // 捕获未知异常
+        std::string errorMsg = "ThreadPool task failed with unknown exception";
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (errorCallback) {
+            errorCallback(errorMsg);
         }
+    }
+
+    tasksExecuted.fetch_add(1, std::memory_order_relaxed);
 
-        // 执行任务
-        try {
-            task();
-        } catch (const std::exception& e) {
-            // 捕获任务执行中的异常，调用错误回调
-            std::string errorMsg = std::string("ThreadPool task failed: ") + e.what();
-            std::lock_guard<std::mutex> lock(queueMutex);
-            if (errorCallback) {
-                errorCallback(errorMsg);
+    // 任务执行完成，减少活跃任务计数；只通知 WaitAll 等待者，不再唤醒空闲工作线程
+    FinishActiveTask();
+}
+
+void ThreadPool::FinishActiveTask() {
+    // 任何使 WaitAll 条件成立的变化最终都表现为 activeTasks 归零，因此只需在此处通知。
+    // 先加锁再通知，保证等待者不会在检查条件与进入等待之间错过通知
+    if (activeTasks.fetch_sub(1) == 1 && completionWaiters.load() > 0) {
+        { std::lock_guard<std::mutex> lock(queueMutex); }
+        completionNotifications.fetch_add(1, std::memory_order_relaxed);
+        completionCondition.notify_all();
+    }
+}
+
+bool ThreadPool::HasQueuedTasks() const {
+    return mode == SchedulingMode::SharedQueue ? !tasks.empty() : queuedTasks.load() > 0;
+}
+
+void ThreadPool::WakeAllWorkers() {
+    // 先加锁再通知，保证等待者不会在检查条件与进入等待之间错过通知
+    { std::lock_guard<std::mutex> lock(queueMutex); }
+    condition.notify_all();
+}
+
+bool ThreadPool::TryRunPendingTask() {
+    if (currentPool != this) {
+        return false;
+    }
+
+    std::function<void()> task;
+    if (mode == SchedulingMode::SharedQueue) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (tasks.empty()) {
+            return false;
+        }
+        task = std::move(tasks.top().taskFunction);
+        tasks.pop();
+        activeTasks++;
+    } else if (!TryAcquireTask(currentWorkerIndex, task)) {
+        return false;
+    }
+
+    ExecuteTask(task);
+    return true;
+}
+
+ThreadPool::TaskGroup::~TaskGroup() {
+    try {
+        Wait();
+    } catch (...) {
+        // 析构时只保证等待完成，异常应由调用方显式调用 Wait() 获取
+    }
+}
+
+void ThreadPool::TaskGroup::Wait() {
+    if (pool.IsWorkerThread()) {
+        // 工作线程内等待：优先协助执行排队任务；没有可执行任务时像空闲工作线程一样休眠，
+        // 由新任务的提交或组内最后一个任务的完成唤醒。先登记等待者再检查组内计数，
+        // 完成方在计数归零后读取登记数，因此不会错过唤醒
+        while (GetPendingCount() > 0) {
+            if (pool.TryRunPendingTask()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(pool.queueMutex);
+            if (pool.stop) {
+                break; // 线程池正在关闭，剩余任务由其他工作线程执行完毕，退回阻塞等待
             }
-        } catch (...) {
-            // 捕获未知异常
-            std::string errorMsg = "ThreadPool task failed with unknown exception";
-            std::lock_guard<std::mutex> lock(queueMutex);
-            if (errorCallback) {
-                errorCallback(errorMsg);
+            state->workerWaiters++;
+            pool.sleepingWorkers++;
+            while (!pool.stop && !pool.HasQueuedTasks() && GetPendingCount() > 0) {
+                pool.condition.wait(lock);
+                pool.workerWakeups.fetch_add(1, std::memory_order_relaxed);
             }
+            pool.sleepingWorkers--;
+            state->workerWaiters--;
         }
+    }
 
-        // 任务执行完成，减少活跃任务计数
-        activeTasks--;
-        
-        // 通知可能在 WaitAll 中等待的线程
-        condition.notify_all();
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [this] { return state->pending == 0; });
     }
-}
\ No newline at end of file
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        error = state->error;
+        state->error = nullptr;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+size_t ThreadPool::TaskGroup::GetPendingCount() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->pending;
+}
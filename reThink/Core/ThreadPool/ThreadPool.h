@@ -3,19 +3,43 @@
 
 #include <functional>
 #include <queue>
+#include <deque>
 #include <vector>
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <cstdint>
 #include <stdexcept>
 #include <future>
+#include <type_traits>
+#include <algorithm>
 
 class ThreadPool {
 public:
-    // 构造函数，初始化线程池，参数为线程数，默认为硬件并发线程数
-    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
-    
+    // 调度模式：共享优先级队列（单锁）或每线程双端队列 + 工作窃取
+    enum class SchedulingMode {
+        SharedQueue,   // 所有任务进入同一个受 queueMutex 保护的优先级队列
+        WorkStealing   // 每个工作线程拥有独立队列，空闲时从其他线程窃取任务
+    };
+
+    class TaskHandle;
+    template<typename T> class Task;
+    class TaskGroup;
+
+    // 调度统计，用于观察锁竞争与唤醒开销
+    struct Stats {
+        uint64_t tasksExecuted = 0;           // 已执行的任务数
+        uint64_t workerWakeups = 0;           // 工作线程从条件变量返回的次数（含虚假唤醒）
+        uint64_t steals = 0;                  // 从其他线程队列窃取的任务数（WorkStealing 模式）
+        uint64_t completionNotifications = 0; // 向 WaitAll 等待者发出的完成通知次数
+    };
+
+    // 构造函数，初始化线程池，参数为线程数（默认为硬件并发线程数）和调度模式
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency(),
+                        SchedulingMode mode = SchedulingMode::SharedQueue);
+
     // 析构函数，停止线程池并清理资源
     ~ThreadPool();
 
@@ -23,7 +47,46 @@ public:
     template<typename F>
     auto EnqueueTask(F&& task, int priority = 0) -> std::future<decltype(task())>;
 
-    // 等待所有任务完成
+    // 任务图：创建一个任务节点，所有依赖完成后才会被调度，工作线程不会因等待依赖而阻塞
+    template<typename F>
+    auto Async(F&& task, const std::vector<TaskHandle>& dependencies, int priority = 0) -> Task<std::invoke_result_t<std::decay_t<F>>>;
+
+    // 任务图：创建一个无依赖的任务节点
+    template<typename F>
+    auto Async(F&& task, int priority = 0) -> Task<std::invoke_result_t<std::decay_t<F>>>;
+
+    // 任务图：所有任务完成后按顺序汇总结果（T 为 void 时仅作为汇合点）
+    template<typename T>
+    auto WhenAll(const std::vector<Task<T>>& tasks, int priority = 0)
+        -> Task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>>;
+
+    // 任务图：等待一组异构任务全部完成的汇合点
+    Task<void> WhenAll(const std::vector<TaskHandle>& tasks, int priority = 0);
+
+    /**
+     * @brief 数据并行循环：将 [begin, end) 切分为若干块，由调用线程与线程池共同执行。
+     *
+     * 块按原子计数器动态领取，负载自动均衡；调用线程也参与执行并只等待已开始的辅助任务，
+     * 因此可以在线程池任务内部（包括持锁时）调用。
+     * @param grainSize 每块的元素数，为 0 时按线程数自动选择。
+     * @param body 接收 (size_t index) 或 (size_t chunkBegin, size_t chunkEnd)。
+     */
+    template<typename F>
+    void ParallelFor(size_t begin, size_t end, size_t grainSize, F&& body, int priority = 0);
+
+    /**
+     * @brief 数据并行归约：每个参与线程持有独立累加器，最后按 combine 合并。
+     *
+     * 块的领取顺序不固定，combine 应满足结合律与交换律（浮点求和结果可能有舍入差异）。
+     * @param grainSize 每块的元素数，为 0 时按线程数自动选择。
+     * @param identity 累加器初始值。
+     * @param body 接收 (size_t chunkBegin, size_t chunkEnd, T& accumulator)。
+     * @param combine 合并两个累加器，签名为 T(const T&, const T&)。
+     */
+    template<typename T, typename F, typename C>
+    T ParallelReduce(size_t begin, size_t end, size_t grainSize, T identity, F&& body, C&& combine, int priority = 0);
+
+    // 等待所有任务完成（由完成条件变量唤醒，不可在线程池任务内部调用）
     void WaitAll();
 
     // 设置错误回调函数，用于任务执行失败时通知调用方
@@ -32,35 +95,140 @@ public:
     // 获取当前任务队列中的任务数（仅用于调试或状态检查）
     size_t GetPendingTaskCount() const;
 
+    // 获取工作线程数
+    size_t GetThreadCount() const { return workers.size(); }
+
+    // 获取构造时选择的调度模式
+    SchedulingMode GetSchedulingMode() const { return mode; }
+
+    // 获取调度统计快照
+    Stats GetStats() const;
+
+    // 当前线程是否是本线程池的工作线程
+    bool IsWorkerThread() const;
+
 private:
     // 任务结构体，包含任务函数和优先级
-    struct Task {
+    struct PrioritizedTask {
         std::function<void()> taskFunction;
         int priority;
 
-        Task(std::function<void()> func, int prio) : taskFunction(std::move(func)), priority(prio) {}
+        PrioritizedTask(std::function<void()> func, int prio) : taskFunction(std::move(func)), priority(prio) {}
 
         // 用于优先级队列比较，高优先级任务先执行
-        bool operator<(const Task& other) const {
+        bool operator<(const PrioritizedTask& other) const {
             return priority < other.priority;
         }
     };
 
-    // 工作线程函数
-    void WorkerThread();
+    // 任务图节点：记录尚未完成的依赖数和完成后需要释放的后继节点
+    struct TaskNode {
+        std::function<void()> work;
+        int priority = 0;
+        std::atomic<size_t> pendingDependencies{1}; // 初始的 1 由创建者持有，声明完依赖后释放
+        std::mutex mutex;                           // 保护 finished 与 successors
+        bool finished = false;
+        std::vector<std::shared_ptr<TaskNode>> successors;
+    };
+
+    // 登记 after 依赖 before；before 已完成时不产生依赖
+    static void AddDependency(const std::shared_ptr<TaskNode>& before, const std::shared_ptr<TaskNode>& after);
+
+    // 释放节点的一个依赖，依赖全部满足时提交到队列
+    void ReleaseNode(const std::shared_ptr<TaskNode>& node);
+
+    // 执行节点并释放其后继
+    void RunNode(const std::shared_ptr<TaskNode>& node);
+
+    // 为一组依赖创建并启动节点
+    void StartNode(const std::shared_ptr<TaskNode>& node, const std::vector<TaskHandle>& dependencies);
+
+    // 工作窃取模式下的优先级通道数：高（priority > 0）、普通（priority == 0）、低（priority < 0）
+    static constexpr size_t kPriorityLanes = 3;
+
+    // 工作窃取模式下每个工作线程的本地队列，每个优先级通道一个双端队列
+    // 所有者从队尾取（LIFO，缓存友好），窃取者从队首取（FIFO，减少冲突）
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> lanes[kPriorityLanes];
+    };
+
+    // 将已包装的任务分发到共享队列或某个工作线程的本地队列
+    void Submit(std::function<void()> taskFunction, int priority);
+
+    // 工作线程函数，index 为该线程在 workers 中的下标
+    void WorkerThread(size_t index);
+
+    // 工作窃取模式：按优先级通道依次尝试本地队列和其他线程的队列，取到任务时计入 activeTasks
+    bool TryAcquireTask(size_t index, std::function<void()>& task);
+
+    // 执行单个任务并处理异常
+    void ExecuteTask(std::function<void()>& task);
+
+    // 在当前工作线程上执行一个排队中的任务，供 TaskGroup::Wait 在工作线程内等待时协助执行
+    bool TryRunPendingTask();
+
+    // 活跃任务数减一；降为零且有 WaitAll 等待者时发出完成通知
+    void FinishActiveTask();
+
+    // 是否有排队中的任务，需持有 queueMutex
+    bool HasQueuedTasks() const;
+
+    // 唤醒所有休眠的工作线程，供任务组完成时通知在工作线程上等待该组的线程
+    void WakeAllWorkers();
+
+    // 自动粒度下每个线程平均分到的块数，越大负载越均衡、调度开销越高
+    static constexpr size_t kChunksPerThread = 8;
+
+    // 计算数据并行的实际粒度
+    size_t ResolveGrainSize(size_t count, size_t grainSize) const;
+
+    // 数据并行的公共实现：participant(slot) 由调用线程与至多 helperCount 个任务并行执行
+    template<typename P>
+    void RunParticipants(size_t helperCount, P&& participant, int priority);
+
+    // 将整数优先级映射到优先级通道
+    static size_t LaneForPriority(int priority);
+
+    // 调度模式
+    const SchedulingMode mode;
 
     // 线程池中的线程集合
     std::vector<std::thread> workers;
 
-    // 任务队列，使用优先级队列管理
-    std::priority_queue<Task> tasks;
+    // 任务队列，使用优先级队列管理（SharedQueue 模式）
+    std::priority_queue<PrioritizedTask> tasks;
+
+    // 每个工作线程的本地队列（WorkStealing 模式）
+    std::vector<std::unique_ptr<WorkerQueue>> localQueues;
+
+    // 外部线程提交任务时轮询选择目标队列
+    std::atomic<size_t> nextQueue;
+
+    // 本地队列中尚未被取走的任务总数（WorkStealing 模式）
+    std::atomic<size_t> queuedTasks;
 
-    // 互斥锁，保护任务队列
+    // 正在条件变量上休眠的工作线程数，提交任务时据此决定是否需要唤醒
+    std::atomic<size_t> sleepingWorkers;
+
+    // 互斥锁，保护共享任务队列以及休眠/唤醒协议
     mutable std::mutex queueMutex;
 
-    // 条件变量，用于线程同步
+    // 条件变量，用于向工作线程分发任务
     std::condition_variable condition;
 
+    // 完成条件变量，仅在线程池变为空闲时唤醒 WaitAll 等待者，与任务分发互不干扰
+    std::condition_variable completionCondition;
+
+    // 正在 WaitAll 中等待的线程数
+    std::atomic<size_t> completionWaiters;
+
+    // 调度统计计数器
+    std::atomic<uint64_t> tasksExecuted;
+    std::atomic<uint64_t> workerWakeups;
+    std::atomic<uint64_t> steals;
+    std::atomic<uint64_t> completionNotifications;
+
     // 停止标志，控制线程池退出
     std::atomic<bool> stop;
 
@@ -74,7 +242,7 @@ private:
 template<typename F>
 auto ThreadPool::EnqueueTask(F&& task, int priority) -> std::future<decltype(task())> {
     using ReturnType = decltype(task());
-    
+
     // 创建 packaged_task 以支持返回值
     auto packagedTask = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<F>(task));
     std::future<ReturnType> future = packagedTask->get_future();
@@ -83,20 +251,341 @@ auto ThreadPool::EnqueueTask(F&& task, int priority) -> std::future<decltype(tas
         throw std::invalid_argument("ThreadPool: Cannot enqueue null task");
     }
 
+    // 将任务包装为 void() 函数，交由调度器分发
+    Submit([packagedTask]() { (*packagedTask)(); }, priority);
+
+    return future;
+}
+
+/**
+ * @brief 任务图中的无类型句柄，仅用于声明依赖关系。
+ */
+class ThreadPool::TaskHandle {
+public:
+    TaskHandle() = default;
+
+    // 节点是否已执行完毕（无论成功或抛出异常）
+    bool IsFinished() const {
+        if (!node) return true;
+        std::lock_guard<std::mutex> lock(node->mutex);
+        return node->finished;
+    }
+
+    bool Valid() const { return node != nullptr; }
+
+protected:
+    friend class ThreadPool;
+
+    TaskHandle(ThreadPool* pool, std::shared_ptr<TaskNode> node) : pool(pool), node(std::move(node)) {}
+
+    ThreadPool* pool = nullptr;
+    std::shared_ptr<TaskNode> node;
+};
+
+/**
+ * @brief 任务图中带返回值的任务。
+ *
+ * 结果保存在 std::shared_future 中，可被多个后继读取。任务抛出的异常会传递给
+ * 读取结果的后继任务以及调用 Get() 的线程。在线程池任务内部应使用 Then()/WhenAll()
+ * 串联后续工作，而不是调用 Get()/Wait() 阻塞工作线程。
+ */
+template<typename T>
+class ThreadPool::Task : public ThreadPool::TaskHandle {
+public:
+    Task() = default;
+
+    // 阻塞等待结果（仅供非线程池线程使用）
+    decltype(auto) Get() const { return result.get(); }
+
+    // 阻塞等待完成（仅供非线程池线程使用）
+    void Wait() const { result.wait(); }
+
+    // 结果是否已就绪
+    bool IsReady() const {
+        return result.valid() && result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    std::shared_future<T> GetFuture() const { return result; }
+
+    /**
+     * @brief 注册后续任务，本任务完成后以其结果调用 continuation。
+     * @param continuation 对 void 任务为无参函数，否则接收 const T&。
+     * @param priority 后续任务的优先级。
+     * @return 后续任务。
+     */
+    template<typename F>
+    auto Then(F&& continuation, int priority = 0) const {
+        std::shared_future<T> source = result;
+        return pool->Async([source, fn = std::forward<F>(continuation)]() mutable {
+            if constexpr (std::is_void_v<T>) {
+                source.get(); // 传播前驱异常
+                return fn();
+            } else {
+                return fn(source.get());
+            }
+        }, std::vector<TaskHandle>{*this}, priority);
+    }
+
+private:
+    friend class ThreadPool;
+
+    Task(ThreadPool* pool, std::shared_ptr<TaskNode> node, std::shared_future<T> result)
+        : TaskHandle(pool, std::move(node)), result(std::move(result)) {}
+
+    std::shared_future<T> result;
+};
+
+/**
+ * @brief 任务组：只等待本组提交的任务，使子系统之间的等待互不影响。
+ *
+ * Wait() 由组内计数归零时的条件变量唤醒；若在本线程池的工作线程中调用，
+ * 等待期间会协助执行排队中的任务，避免嵌套等待耗尽工作线程，没有可执行的任务时
+ * 与空闲工作线程一起休眠，由新任务的提交或组内最后一个任务的完成唤醒。组内任务抛出的
+ * 第一个异常会在 Wait() 中重新抛出。析构时会等待组内剩余任务完成。
+ */
+class ThreadPool::TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool), state(std::make_shared<State>()) {}
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // 向组内提交任务
+    template<typename F>
+    void Run(F&& task, int priority = 0);
+
+    // 等待组内所有任务完成
+    void Wait();
+
+    // 组内尚未完成的任务数
+    size_t GetPendingCount() const;
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t pending = 0;
+        std::exception_ptr error;
+        std::atomic<size_t> workerWaiters{0}; // 在工作线程上休眠等待本组的线程数
+    };
+
+    ThreadPool& pool;
+    std::shared_ptr<State> state;
+};
+
+template<typename F>
+void ThreadPool::TaskGroup::Run(F&& task, int priority) {
     {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        if (stop) {
-            throw std::runtime_error("ThreadPool: Cannot enqueue task after shutdown");
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->pending++;
+    }
+
+    std::shared_ptr<State> groupState = state;
+    ThreadPool* owner = &pool;
+    try {
+        pool.Submit([groupState, owner, fn = std::forward<F>(task)]() mutable {
+            std::exception_ptr error;
+            try {
+                fn();
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            bool finished = false;
+            {
+                std::lock_guard<std::mutex> lock(groupState->mutex);
+                if (error && !groupState->error) {
+                    groupState->error = error;
+                }
+                if (--groupState->pending == 0) {
+                    finished = true;
+                    groupState->done.notify_all();
+                }
+            }
+            // 在工作线程上等待本组的线程休眠在线程池的条件变量上，需要一并唤醒
+            if (finished && groupState->workerWaiters.load() > 0) {
+                owner->WakeAllWorkers();
+            }
+        }, priority);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->pending--;
+        throw;
+    }
+}
+
+template<typename P>
+void ThreadPool::RunParticipants(size_t helperCount, P&& participant, int priority) {
+    // 辅助任务开始执行时先登记；调用线程完成自己的工作后关闭登记，只等待已经开始的辅助任务。
+    // 尚未被调度的辅助任务之后只会直接返回，因此调用线程无需等待它们出队，也不会在等待中执行无关任务
+    struct SharedState {
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t active = 0;
+        bool closed = false;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<SharedState>();
+
+    for (size_t slot = 1; slot <= helperCount; ++slot) {
+        try {
+            Submit([state, &participant, slot]() {
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (state->closed) return;
+                    state->active++;
+                }
+                std::exception_ptr error;
+                try {
+                    participant(slot);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (error && !state->error) state->error = error;
+                if (--state->active == 0) state->done.notify_all();
+            }, priority);
+        } catch (const std::runtime_error&) {
+            break; // 线程池正在关闭，剩余工作由调用线程完成
         }
+    }
 
-        // 将任务包装为 void() 函数，放入优先级队列
-        tasks.emplace([packagedTask]() { (*packagedTask)(); }, priority);
+    std::exception_ptr error;
+    try {
+        participant(0);
+    } catch (...) {
+        error = std::current_exception();
     }
 
-    // 通知一个等待的工作线程
-    condition.notify_one();
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->closed = true;
+    state->done.wait(lock, [&state] { return state->active == 0; });
+    if (!error) error = state->error;
+    lock.unlock();
 
-    return future;
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+template<typename F>
+void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grainSize, F&& body, int priority) {
+    if (begin >= end) return;
+
+    const size_t count = end - begin;
+    const size_t grain = ResolveGrainSize(count, grainSize);
+    const size_t chunkCount = (count + grain - 1) / grain;
+
+    auto runChunk = [&](size_t chunkBegin, size_t chunkEnd) {
+        if constexpr (std::is_invocable_v<F&, size_t, size_t>) {
+            body(chunkBegin, chunkEnd);
+        } else {
+            for (size_t i = chunkBegin; i < chunkEnd; ++i) body(i);
+        }
+    };
+
+    // 只有一块时直接在调用线程执行
+    if (chunkCount == 1) {
+        runChunk(begin, end);
+        return;
+    }
+
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<bool> failed{false};
+    RunParticipants(std::min(chunkCount - 1, workers.size()), [&](size_t) {
+        try {
+            for (size_t chunk = nextChunk.fetch_add(1); chunk < chunkCount && !failed; chunk = nextChunk.fetch_add(1)) {
+                size_t chunkBegin = begin + chunk * grain;
+                runChunk(chunkBegin, std::min(chunkBegin + grain, end));
+            }
+        } catch (...) {
+            failed = true;
+            throw;
+        }
+    }, priority);
+}
+
+template<typename T, typename F, typename C>
+T ThreadPool::ParallelReduce(size_t begin, size_t end, size_t grainSize, T identity, F&& body, C&& combine, int priority) {
+    if (begin >= end) return identity;
+
+    const size_t count = end - begin;
+    const size_t grain = ResolveGrainSize(count, grainSize);
+    const size_t chunkCount = (count + grain - 1) / grain;
+
+    if (chunkCount == 1) {
+        T accumulator = identity;
+        body(begin, end, accumulator);
+        return accumulator;
+    }
+
+    // 每个参与者一个累加器，彼此之间无共享写入
+    const size_t helperCount = std::min(chunkCount - 1, workers.size());
+    std::vector<T> accumulators(helperCount + 1, identity);
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<bool> failed{false};
+    RunParticipants(helperCount, [&](size_t slot) {
+        try {
+            T& accumulator = accumulators[slot];
+            for (size_t chunk = nextChunk.fetch_add(1); chunk < chunkCount && !failed; chunk = nextChunk.fetch_add(1)) {
+                size_t chunkBegin = begin + chunk * grain;
+                body(chunkBegin, std::min(chunkBegin + grain, end), accumulator);
+            }
+        } catch (...) {
+            failed = true;
+            throw;
+        }
+    }, priority);
+
+    T result = std::move(accumulators[0]);
+    for (size_t slot = 1; slot < accumulators.size(); ++slot) {
+        result = combine(result, accumulators[slot]);
+    }
+    return result;
+}
+
+template<typename F>
+auto ThreadPool::Async(F&& task, const std::vector<TaskHandle>& dependencies, int priority)
+    -> Task<std::invoke_result_t<std::decay_t<F>>> {
+    using ReturnType = std::invoke_result_t<std::decay_t<F>>;
+
+    auto packagedTask = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<F>(task));
+    std::shared_future<ReturnType> future = packagedTask->get_future().share();
+
+    auto node = std::make_shared<TaskNode>();
+    node->work = [packagedTask]() { (*packagedTask)(); };
+    node->priority = priority;
+    StartNode(node, dependencies);
+
+    return Task<ReturnType>(this, node, std::move(future));
+}
+
+template<typename F>
+auto ThreadPool::Async(F&& task, int priority) -> Task<std::invoke_result_t<std::decay_t<F>>> {
+    return Async(std::forward<F>(task), std::vector<TaskHandle>{}, priority);
+}
+
+template<typename T>
+auto ThreadPool::WhenAll(const std::vector<Task<T>>& tasks, int priority)
+    -> Task<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> {
+    std::vector<TaskHandle> dependencies(tasks.begin(), tasks.end());
+    std::vector<std::shared_future<T>> results;
+    results.reserve(tasks.size());
+    for (const auto& task : tasks) {
+        results.push_back(task.GetFuture());
+    }
+
+    return Async([results = std::move(results)]() {
+        if constexpr (std::is_void_v<T>) {
+            for (const auto& result : results) result.get();
+        } else {
+            std::vector<T> values;
+            values.reserve(results.size());
+            for (const auto& result : results) values.push_back(result.get());
+            return values;
+        }
+    }, dependencies, priority);
 }
 
-#endif // THREADPOOL_H
\ No newline at end of file
+#endif // THREADPOOL_H
@@ -0,0 +1,188 @@
+﻿#include "ThreadPoolSelfTest.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    // 任务图每层的节点数与层数
+    constexpr size_t kGraphWidth = 256;
+    constexpr size_t kGraphLayers = 16;
+    // 嵌套用例中每个线程对应的外层任务数，远多于线程数，使所有工作线程同时处在嵌套等待中
+    constexpr size_t kOuterTasksPerThread = 8;
+    constexpr size_t kInnerTasks = 16;
+
+    void Check(bool condition, const std::string& message) {
+        if (!condition) throw std::runtime_error(message);
+    }
+
+    /**
+     * @brief 分层任务图：每个节点依赖上一层的三个节点，结果与串行计算比较。
+     */
+    void RunLayeredGraph(ThreadPool& pool) {
+        std::vector<ThreadPool::Task<uint64_t>> layer;
+        std::vector<uint64_t> expected(kGraphWidth);
+        for (size_t i = 0; i < kGraphWidth; ++i) {
+            layer.push_back(pool.Async([i]() { return static_cast<uint64_t>(i); }));
+            expected[i] = i;
+        }
+
+        for (size_t depth = 0; depth < kGraphLayers; ++depth) {
+            std::vector<ThreadPool::Task<uint64_t>> next;
+            std::vector<uint64_t> nextExpected(kGraphWidth);
+            for (size_t i = 0; i < kGraphWidth; ++i) {
+                auto a = layer[i], b = layer[(i + 1) % kGraphWidth], c = layer[(i + 7) % kGraphWidth];
+                // 依赖都已完成才会执行，这里读取结果不会阻塞
+                next.push_back(pool.Async([a, b, c]() { return a.Get() + b.Get() * 3 + c.Get() * 7 + 1; },
+                                          {a, b, c}));
+                nextExpected[i] = expected[i] + expected[(i + 1) % kGraphWidth] * 3 + expected[(i + 7) % kGraphWidth] * 7 + 1;
+            }
+            layer = std::move(next);
+            expected = std::move(nextExpected);
+        }
+
+        std::vector<uint64_t> result = pool.WhenAll(layer).Get();
+        Check(result == expected, "分层任务图的结果与串行计算不一致");
+    }
+
+    /**
+     * @brief 嵌套依赖：外层任务在工作线程上发起内层任务图，只以依赖与后续任务串联，不阻塞等待，
+     * 与生成器先在 Prepare 中发起加载、加载完成后再执行 Generate 的方式相同。
+     */
+    void RunNestedGraph(ThreadPool& pool) {
+        const size_t outerCount = pool.GetThreadCount() * kOuterTasksPerThread;
+        std::vector<ThreadPool::Task<ThreadPool::Task<uint64_t>>> outer;
+        for (size_t i = 0; i < outerCount; ++i) {
+            outer.push_back(pool.Async([&pool, i]() {
+                std::vector<ThreadPool::Task<uint64_t>> loads;
+                for (size_t j = 0; j < kInnerTasks; ++j) {
+                    loads.push_back(pool.Async([i, j]() { return static_cast<uint64_t>(i * kInnerTasks + j); })
+                                        .Then([](uint64_t value) { return value * 2; }));
+                }
+                return pool.WhenAll(loads).Then([](const std::vector<uint64_t>& values) {
+                    uint64_t sum = 0;
+                    for (uint64_t value : values) sum += value;
+                    return sum;
+                });
+            }));
+        }
+
+        uint64_t total = 0;
+        for (const auto& task : outer) {
+            total += task.Get().Get();
+        }
+        const uint64_t n = outerCount * kInnerTasks;
+        Check(total == n * (n - 1), "嵌套任务图的结果错误");
+    }
+
+    /**
+     * @brief 嵌套等待：所有工作线程同时在任务组中等待内层任务，内层任务再嵌套任务组与数据并行。
+     */
+    void RunNestedGroups(ThreadPool& pool) {
+        std::atomic<uint64_t> leaves{0};
+        const size_t outerCount = pool.GetThreadCount() * kOuterTasksPerThread;
+        ThreadPool::TaskGroup outer(pool);
+        for (size_t i = 0; i < outerCount; ++i) {
+            outer.Run([&pool, &leaves]() {
+                ThreadPool::TaskGroup middle(pool);
+                for (size_t j = 0; j < kInnerTasks; ++j) {
+                    middle.Run([&pool, &leaves]() {
+                        ThreadPool::TaskGroup inner(pool);
+                        for (size_t k = 0; k < 4; ++k) {
+                            inner.Run([&leaves]() { leaves.fetch_add(1); });
+                        }
+                        pool.ParallelFor(0, 64, 1, [&leaves](size_t) { leaves.fetch_add(1); });
+                        inner.Wait();
+                    });
+                }
+                middle.Wait();
+            });
+        }
+        outer.Wait();
+        Check(leaves.load() == outerCount * kInnerTasks * (4 + 64), "嵌套任务组漏执行了任务");
+    }
+
+    /**
+     * @brief 前驱抛出的异常沿依赖传播到后续任务与汇合点。
+     */
+    void RunErrorPropagation(ThreadPool& pool) {
+        auto failing = pool.Async([]() -> int { throw std::runtime_error("expected"); });
+        auto continuation = failing.Then([](int value) { return value + 1; });
+        auto joined = pool.WhenAll(std::vector<ThreadPool::Task<int>>{continuation, pool.Async([]() { return 1; })});
+        bool thrown = false;
+        try {
+            joined.Get();
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        Check(thrown, "前驱的异常没有传播到汇合点");
+    }
+
+    const char* ModeName(ThreadPool::SchedulingMode mode) {
+        return mode == ThreadPool::SchedulingMode::WorkStealing ? "WorkStealing" : "SharedQueue";
+    }
+}
+
+int ThreadPoolSelfTest::RunCommandLine(int argc, char** argv) {
+    long timeoutSeconds = 60;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--selftest") {
+            continue;
+        } else if (arg == "--timeout" && i + 1 < argc) {
+            timeoutSeconds = std::strtol(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "用法: reThink --selftest [--timeout <秒>]" << std::endl;
+            return 2;
+        }
+    }
+
+    struct Case {
+        const char* name;
+        void (*run)(ThreadPool&);
+    };
+    const Case cases[] = {
+        {"分层任务图", RunLayeredGraph},
+        {"嵌套任务图", RunNestedGraph},
+        {"嵌套任务组", RunNestedGroups},
+        {"异常传播", RunErrorPropagation},
+    };
+
+    int failed = 0;
+    for (size_t threadCount : {1, 2, 4}) {
+        for (auto mode : {ThreadPool::SchedulingMode::SharedQueue, ThreadPool::SchedulingMode::WorkStealing}) {
+            for (const Case& testCase : cases) {
+                auto start = std::chrono::steady_clock::now();
+                // 在独立线程上运行，死锁时主线程仍能超时返回
+                auto result = std::async(std::launch::async, [&testCase, threadCount, mode]() {
+                    ThreadPool pool(threadCount, mode);
+                    testCase.run(pool);
+                });
+                if (result.wait_for(std::chrono::seconds(timeoutSeconds)) != std::future_status::ready) {
+                    std::cerr << "[SelfTest] " << testCase.name << "（" << threadCount << " 线程，" << ModeName(mode)
+                              << "）超过 " << timeoutSeconds << " s 未完成，疑似死锁" << std::endl;
+                    // 死锁的线程池无法析构，直接结束进程
+                    std::_Exit(1);
+                }
+
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                try {
+                    result.get();
+                    std::cout << "[SelfTest] 通过 " << testCase.name << "（" << threadCount << " 线程，" << ModeName(mode)
+                              << "）" << ms << " ms" << std::endl;
+                } catch (const std::exception& e) {
+                    failed++;
+                    std::cerr << "[SelfTest] 失败 " << testCase.name << "（" << threadCount << " 线程，" << ModeName(mode)
+                              << "）: " << e.what() << std::endl;
+                }
+            }
+        }
+    }
+
+    std::cout << "[SelfTest] " << (failed == 0 ? "全部通过" : std::to_string(failed) + " 个用例失败") << std::endl;
+    return failed == 0 ? 0 : 1;
+}
\ No newline at end of file
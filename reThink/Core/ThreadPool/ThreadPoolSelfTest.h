@@ -0,0 +1,15 @@
+﻿#pragma once
+
+/**
+ * @brief 线程池自检：用嵌套的任务依赖占满线程池，确认任务图、任务组与数据并行不会死锁。
+ *
+ * 对 1、2、4 个线程与两种调度模式分别运行，每个用例在独立线程上执行并限时，
+ * 超时视为死锁。命令行入口：reThink --selftest [--timeout <秒>]
+ */
+class ThreadPoolSelfTest {
+public:
+    /**
+     * @brief 命令行入口，全部用例通过时返回 0。
+     */
+    static int RunCommandLine(int argc, char** argv);
+};
\ No newline at end of file
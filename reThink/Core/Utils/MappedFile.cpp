@@ -0,0 +1,106 @@
+﻿// Utils/MappedFile.cpp
+#include "MappedFile.h"
+#include <utility>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw MappedFileException("无法打开文件: " + path.string());
+    }
+    file_ = file;
+    open_ = true;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        Close();
+        throw MappedFileException("无法获取文件大小: " + path.string());
+    }
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ == 0) return;
+
+    mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_) {
+        Close();
+        throw MappedFileException("无法创建文件映射: " + path.string());
+    }
+    data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_) {
+        Close();
+        throw MappedFileException("无法映射文件: " + path.string());
+    }
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw MappedFileException("无法打开文件: " + path.string());
+    }
+    open_ = true;
+
+    struct stat status;
+    if (fstat(fd_, &status) != 0) {
+        Close();
+        throw MappedFileException("无法获取文件大小: " + path.string());
+    }
+    size_ = static_cast<size_t>(status.st_size);
+    if (size_ == 0) return;
+
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (data == MAP_FAILED) {
+        Close();
+        throw MappedFileException("无法映射文件: " + path.string());
+    }
+    data_ = static_cast<const uint8_t*>(data);
+    // 映射通常被顺序读取
+    madvise(data, size_, MADV_SEQUENTIAL);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(open_, other.open_);
+#ifdef _WIN32
+        std::swap(file_, other.file_);
+        std::swap(mapping_, other.mapping_);
+#else
+        std::swap(fd_, other.fd_);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::Close() noexcept {
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+    mapping_ = nullptr;
+    file_ = nullptr;
+#else
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+﻿// Utils/MappedFile.h
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <filesystem>
+
+/**
+ * @brief 文件映射异常
+ */
+class MappedFileException : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief 只读内存映射文件
+ *
+ * 整个文件映射到进程地址空间，按需由操作系统换入页面，读取时不经过额外的缓冲拷贝。
+ * 映射在对象析构或 Close() 之前保持有效；Windows 上映射期间文件不能被删除或替换。
+ * 空文件可以打开，此时 Data() 为空指针、Size() 为 0。
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief 打开并映射文件
+     * @param path 文件路径
+     * @throws MappedFileException 文件不存在或映射失败时抛出
+     */
+    explicit MappedFile(const std::filesystem::path& path);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* Data() const noexcept { return data_; }
+    size_t Size() const noexcept { return size_; }
+    bool IsOpen() const noexcept { return open_; }
+
+    /**
+     * @brief 解除映射并关闭文件
+     */
+    void Close() noexcept;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+#ifdef _WIN32
+    void* file_ = nullptr;     // HANDLE
+    void* mapping_ = nullptr;  // HANDLE
+#else
+    int fd_ = -1;
+#endif
+};
\ No newline at end of file
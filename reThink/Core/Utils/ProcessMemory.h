@@ -0,0 +1,16 @@
+﻿// Utils/ProcessMemory.h
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief 进程内存统计
+ *
+ * 平台相关的实现位于 ProcessMemory.cpp，系统头文件不会泄漏到调用方。
+ */
+class ProcessMemory {
+public:
+    /**
+     * @brief 进程启动以来的内存峰值（字节），不支持的平台返回 0
+     */
+    static uint64_t GetPeakBytes();
+};
\ No newline at end of file
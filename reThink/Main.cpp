@@ -2,11 +2,26 @@
 #include "stb_image.h"
 #include <iostream>
 #include "Modules/Window/Window.h"
+#include "Procedural/ProceduralBatch/ProceduralBatch.h"
+#include "Core/ThreadPool/ThreadPoolSelfTest.h"
+#include "Procedural/WFCGenerator/WFCBenchmark.h"
 
 using namespace MyRenderer;
 
 int main(int argc, char** argv) {
     system("chcp 65001");
+    // 批处理模式只运行程序化生成，不创建窗口和 OpenGL 上下文
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        return ProceduralBatch::RunCommandLine(argc, argv);
+    }
+    // 线程池自检，同样不创建窗口
+    if (argc > 1 && std::string(argv[1]) == "--selftest") {
+        return ThreadPoolSelfTest::RunCommandLine(argc, argv);
+    }
+    // WFC 求解器基准
+    if (argc > 1 && std::string(argv[1]) == "--bench-wfc") {
+        return WFCBenchmark::RunCommandLine(argc, argv);
+    }
     std::cout << "当前工作目录: " << std::filesystem::current_path() << std::endl;
     try {
         std::cout << "=== 应用程序启动 ===" << std::endl;
@@ -139,7 +139,7 @@ void ControlPanel::RenderModelTransform() {
             eventBus_->Publish(Events::ModelTransformedEvent{uuid, oldTransform});
         };
         eventBus_->Publish(Events::PushUndoOperationEvent{op});
-        eventBus_->Publish(Events::ModelTransformedEvent{currentModel_.uuid, newTransform});
+        eventBus_->Enqueue(Events::ModelTransformedEvent{currentModel_.uuid, newTransform});
     }
 
     glm::vec3 eulerAngles = glm::degrees(glm::eulerAngles(rotation));
@@ -159,7 +159,7 @@ void ControlPanel::RenderModelTransform() {
             eventBus_->Publish(Events::ModelTransformedEvent{uuid, oldTransform});
         };
         eventBus_->Publish(Events::PushUndoOperationEvent{op});
-        eventBus_->Publish(Events::ModelTransformedEvent{currentModel_.uuid, newTransform});
+        eventBus_->Enqueue(Events::ModelTransformedEvent{currentModel_.uuid, newTransform});
     }
 
     if (ImGui::DragFloat3(u8"缩放", &scale[0], 0.01f)) {
@@ -177,7 +177,7 @@ void ControlPanel::RenderModelTransform() {
             eventBus_->Publish(Events::ModelTransformedEvent{uuid, oldTransform});
         };
         eventBus_->Publish(Events::PushUndoOperationEvent{op});
-        eventBus_->Publish(Events::ModelTransformedEvent{currentModel_.uuid, newTransform});
+        eventBus_->Enqueue(Events::ModelTransformedEvent{currentModel_.uuid, newTransform});
     }
 }
 
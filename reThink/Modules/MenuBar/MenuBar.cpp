@@ -8,7 +8,7 @@
 namespace MyRenderer {
 
 MenuBar::MenuBar(std::shared_ptr<EventBus> eventBus, ConfigManager& configManager)
-    : eventBus_(eventBus), configManager_(configManager), showErrorPopup_(false) {
+    : eventBus_(eventBus), configManager_(configManager), showErrorPopup_(false), showEventQueueStats_(false) {
     // 订阅ProjectLoadFailedEvent
     eventBus_->Subscribe<Events::ProjectLoadFailedEvent>([this](const Events::ProjectLoadFailedEvent& event) {
         errorMessage_ = event.errorMsg;
@@ -25,6 +25,10 @@ void MenuBar::Update() {
     if (showErrorPopup_) {
         ShowErrorPopup();
     }
+
+    if (showEventQueueStats_) {
+        ShowEventQueueStats();
+    }
 }
 
 void MenuBar::DrawMenuBar() {
@@ -130,6 +134,8 @@ void MenuBar::HandleViewMenu() {
             config.flags = ImGuiFileDialogFlags_Modal;
             ImGuiFileDialog::Instance()->OpenDialog("SaveLayoutDlg", "Save Layout As", ".ini", config);
         }
+        ImGui::Separator();
+        ImGui::MenuItem("Event Queue Stats", nullptr, &showEventQueueStats_);
         ImGui::EndMenu();
     }
 
@@ -181,4 +187,15 @@ void MenuBar::ShowErrorPopup() {
     }
 }
 
+void MenuBar::ShowEventQueueStats() {
+    // 显示上一帧排队事件的入队、合并与分发数量
+    if (ImGui::Begin("Event Queue Stats", &showEventQueueStats_, ImGuiWindowFlags_AlwaysAutoResize)) {
+        EventBus::QueueStats stats = eventBus_->GetQueueStats();
+        ImGui::Text("Enqueued: %zu", stats.enqueued);
+        ImGui::Text("Coalesced: %zu", stats.coalesced);
+        ImGui::Text("Dispatched: %zu", stats.dispatched);
+    }
+    ImGui::End();
+}
+
 } // namespace MyRenderer
\ No newline at end of file
@@ -41,10 +41,12 @@ namespace MyRenderer {
         void HandleViewMenu();
         void HandleImportMenu();
         void ShowErrorPopup();
+        void ShowEventQueueStats();
 
         std::shared_ptr<EventBus> eventBus_;
         ConfigManager& configManager_;
         bool showErrorPopup_;
+        bool showEventQueueStats_;
         std::string errorMessage_;
     };
 
@@ -5,7 +5,7 @@
 namespace fs = std::filesystem;
 
 ProceduralWindow::ProceduralWindow(std::shared_ptr<EventBus> eventBus, std::shared_ptr<ModelLoader> modelLoader)
-    : eventBus_(eventBus), modelLoader_(modelLoader), generationProgress_(0.0f), isGenerating_(false) {
+    : eventBus_(eventBus), modelLoader_(modelLoader), generationProgress_(0.0f), isGenerating_(false), currentJobId_(0) {
     if (!eventBus_) throw std::invalid_argument("ProceduralWindow: EventBus cannot be null");
     if (!modelLoader_) throw std::invalid_argument("ProceduralWindow: ModelLoader cannot be null");
     LoadAlgorithmsFromConfig();
@@ -64,8 +64,12 @@ void ProceduralWindow::SaveToConfig() {
 }
 
 void ProceduralWindow::SubscribeToEvents() {
+    // 任务事件由主线程的 DispatchQueued 分发，但不同类型之间不保证顺序，
+    // 同一任务的完成事件可能先于开始事件到达，因此只接受不早于当前任务的事件
     eventBus_->Subscribe<MyRenderer::Events::ProceduralGenerationStartedEvent>(
-        [this](const MyRenderer::Events::ProceduralGenerationStartedEvent&) {
+        [this](const MyRenderer::Events::ProceduralGenerationStartedEvent& event) {
+            if (event.jobId <= currentJobId_) return;
+            currentJobId_ = event.jobId;
             isGenerating_ = true;
             generationProgress_ = 0.0f;
             resultMessage_ = "Generation started...";
@@ -73,11 +77,17 @@ void ProceduralWindow::SubscribeToEvents() {
 
     eventBus_->Subscribe<MyRenderer::Events::ProgressUpdateEvent>(
         [this](const MyRenderer::Events::ProgressUpdateEvent& event) {
+            if (event.jobId != currentJobId_) return;
             generationProgress_ = event.progress;
         });
 
     eventBus_->Subscribe<MyRenderer::Events::ProceduralGenerationCompletedEvent>(
         [this](const MyRenderer::Events::ProceduralGenerationCompletedEvent& event) {
+            // jobId 为 0 表示请求未能创建任务
+            if (event.jobId != 0) {
+                if (event.jobId < currentJobId_) return;
+                currentJobId_ = event.jobId;
+            }
             isGenerating_ = false;
             if (event.success) {
                 resultMessage_ = "Generation completed successfully! UUID: " + event.modelData.uuid;
@@ -87,7 +97,9 @@ void ProceduralWindow::SubscribeToEvents() {
         });
 
     eventBus_->Subscribe<MyRenderer::Events::ProceduralGenerationStoppedEvent>(
-        [this](const MyRenderer::Events::ProceduralGenerationStoppedEvent&) {
+        [this](const MyRenderer::Events::ProceduralGenerationStoppedEvent& event) {
+            if (event.jobId < currentJobId_) return;
+            currentJobId_ = event.jobId;
             isGenerating_ = false;
             resultMessage_ = "Generation stopped.";
         });
@@ -137,14 +149,13 @@ void ProceduralWindow::RenderParameters() {
             ImGui::Text("No algorithm selected.");
         }
 
-        ImGui::BeginDisabled(isGenerating_);
+        // 生成请求由任务管理器排队执行，生成过程中也可以继续提交
         if (ImGui::Button("Generate")) {
             Generate();
         }
-        ImGui::EndDisabled();
 
         if (isGenerating_ && ImGui::Button("Cancel")) {
-            eventBus_->Publish(MyRenderer::Events::RequestGenerationCancelEvent{});
+            eventBus_->Publish(MyRenderer::Events::RequestGenerationCancelEvent{currentJobId_});
         }
     }
 }
@@ -171,6 +182,11 @@ void ProceduralWindow::GenerateParameterUI(nlohmann::json& params, const nlohman
             if (ImGui::InputFloat(key.c_str(), &val)) {
                 params[key] = val;
             }
+        } else if (type == "bool") {
+            bool val = params[key].get<bool>();
+            if (ImGui::Checkbox(key.c_str(), &val)) {
+                params[key] = val;
+            }
         } else if (type == "string") {
             std::string val = params[key].get<std::string>();
             char buffer[256];
@@ -34,5 +34,6 @@ private:
     nlohmann::json currentParams_;
     float generationProgress_;
     bool isGenerating_;
+    uint64_t currentJobId_; // 最近的生成任务，进度与结果只跟踪该任务；任务 ID 单调递增
     std::string resultMessage_;
 };
\ No newline at end of file
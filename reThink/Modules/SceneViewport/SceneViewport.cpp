@@ -143,10 +143,14 @@ void SceneViewport::Shutdown() {
     for (auto& [uuid, ebo] : eboMap_) {
         glDeleteBuffers(1, &ebo);
     }
+    for (auto& [uuid, vbo] : instanceVboMap_) {
+        glDeleteBuffers(1, &vbo);
+    }
     vaoMap_.clear();
     vboMap_.clear();
     normalVboMap_.clear();
     eboMap_.clear();
+    instanceVboMap_.clear();
 
     // 清理网格和坐标轴资源
     if (gridAxesVao_ != 0) {
@@ -263,6 +267,8 @@ void SceneViewport::SubscribeToEvents() {
         [this](const auto& event) { OnHierarchyUpdate(event); });
     eventBus_->Subscribe<MyRenderer::Events::SceneLightUpdatedEvent>(
         [this](const auto& event) { OnSceneLightUpdated(event); });
+    eventBus_->Subscribe<MyRenderer::Events::ProceduralChunkReadyEvent>(
+        [this](const auto& event) { OnProceduralChunkReady(event); });
 }
 
 void SceneViewport::RenderScene() {
@@ -350,6 +356,19 @@ void SceneViewport::DrawModel(const ModelData& model) {
         // 索引
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, model.indices.size() * sizeof(unsigned int), model.indices.data(), GL_STATIC_DRAW);
+        // 实例变换：mat4 占用 2~5 四个属性位置，每个实例前进一次
+        if (!model.instanceTransforms.empty()) {
+            GLuint instanceVbo;
+            glGenBuffers(1, &instanceVbo);
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+            glBufferData(GL_ARRAY_BUFFER, model.instanceTransforms.size() * sizeof(glm::mat4), model.instanceTransforms.data(), GL_STATIC_DRAW);
+            for (GLuint column = 0; column < 4; ++column) {
+                glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+                glEnableVertexAttribArray(2 + column);
+                glVertexAttribDivisor(2 + column, 1);
+            }
+            instanceVboMap_[model.uuid] = instanceVbo;
+        }
 
         glBindVertexArray(0);
 
@@ -361,17 +380,27 @@ void SceneViewport::DrawModel(const ModelData& model) {
 
     glBindVertexArray(vaoMap_[model.uuid]);
 
+    // 带实例变换的模型一次绘制全部实例
+    GLsizei instanceCount = static_cast<GLsizei>(model.instanceTransforms.size());
+    auto drawElements = [&]() {
+        if (instanceCount > 0) {
+            glDrawElementsInstanced(GL_TRIANGLES, model.indices.size(), GL_UNSIGNED_INT, 0, instanceCount);
+        } else {
+            glDrawElements(GL_TRIANGLES, model.indices.size(), GL_UNSIGNED_INT, 0);
+        }
+    };
+
     // 高亮显示选中模型
     if (model.uuid == selectedModelUUID_) {
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
         glLineWidth(2.0f);
         glUniform3f(glGetUniformLocation(program, "outlineColor"), 0.0f, 1.0f, 1.0f); // 青色 #00FFFF
-        glDrawElements(GL_TRIANGLES, model.indices.size(), GL_UNSIGNED_INT, 0);
+        drawElements();
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
 
     // 正常渲染
-    glDrawElements(GL_TRIANGLES, model.indices.size(), GL_UNSIGNED_INT, 0);
+    drawElements();
 
     // 编辑模式下的高亮
     if (model.uuid == selectedModelUUID_ && currentMode_ != MyRenderer::OperationMode::Object) {
@@ -380,12 +409,16 @@ void SceneViewport::DrawModel(const ModelData& model) {
         switch (currentMode_) {
             case MyRenderer::OperationMode::Vertex:
                 glUniform3f(glGetUniformLocation(program, "highlightColor"), 1.0f, 0.0f, 0.0f); // 红色 #FF0000
-                glDrawArrays(GL_POINTS, 0, model.vertices.size());
+                if (instanceCount > 0) {
+                    glDrawArraysInstanced(GL_POINTS, 0, model.vertices.size(), instanceCount);
+                } else {
+                    glDrawArrays(GL_POINTS, 0, model.vertices.size());
+                }
                 break;
             case MyRenderer::OperationMode::Edge:
                 glUniform3f(glGetUniformLocation(program, "highlightColor"), 1.0f, 1.0f, 0.0f); // 黄色 #FFFF00
                 glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-                glDrawElements(GL_TRIANGLES, model.indices.size(), GL_UNSIGNED_INT, 0);
+                drawElements();
                 glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
                 break;
             case MyRenderer::OperationMode::Face:
@@ -424,7 +457,7 @@ void SceneViewport::HandleImGuizmo() {
                 eventBus_->Publish(MyRenderer::Events::ModelTransformedEvent{uuid, oldTransform});
             };
             eventBus_->Publish(MyRenderer::Events::PushUndoOperationEvent{op});
-            eventBus_->Publish(MyRenderer::Events::ModelTransformedEvent{selectedModelUUID_, newTransform});
+            eventBus_->Enqueue(MyRenderer::Events::ModelTransformedEvent{selectedModelUUID_, newTransform});
         }
     }
 }
@@ -522,17 +555,36 @@ void SceneViewport::OnModelLoaded(const MyRenderer::Events::ModelLoadedEvent& ev
     models_[event.modelData.uuid] = event.modelData;
 }
 
+void SceneViewport::OnProceduralChunkReady(const MyRenderer::Events::ProceduralChunkReadyEvent& event) {
+    // 分块经接缝重解后以相同 UUID 再次发送，需丢弃旧的 GPU 缓冲
+    ReleaseModelBuffers(event.chunkData.uuid);
+    models_[event.chunkData.uuid] = event.chunkData;
+}
+
+void SceneViewport::ReleaseModelBuffers(const std::string& modelUUID) {
+    auto vaoIt = vaoMap_.find(modelUUID);
+    if (vaoIt == vaoMap_.end()) {
+        return;
+    }
+    glDeleteVertexArrays(1, &vaoIt->second);
+    glDeleteBuffers(1, &vboMap_[modelUUID]);
+    glDeleteBuffers(1, &normalVboMap_[modelUUID]);
+    glDeleteBuffers(1, &eboMap_[modelUUID]);
+    vaoMap_.erase(vaoIt);
+    vboMap_.erase(modelUUID);
+    normalVboMap_.erase(modelUUID);
+    eboMap_.erase(modelUUID);
+    auto instanceIt = instanceVboMap_.find(modelUUID);
+    if (instanceIt != instanceVboMap_.end()) {
+        glDeleteBuffers(1, &instanceIt->second);
+        instanceVboMap_.erase(instanceIt);
+    }
+}
+
 void SceneViewport::OnModelDeleted(const MyRenderer::Events::ModelDeletedEvent& event) {
     auto it = models_.find(event.modelUUID);
     if (it != models_.end()) {
-        glDeleteVertexArrays(1, &vaoMap_[event.modelUUID]);
-        glDeleteBuffers(1, &vboMap_[event.modelUUID]);
-        glDeleteBuffers(1, &normalVboMap_[event.modelUUID]);
-        glDeleteBuffers(1, &eboMap_[event.modelUUID]);
-        vaoMap_.erase(event.modelUUID);
-        vboMap_.erase(event.modelUUID);
-        normalVboMap_.erase(event.modelUUID);
-        eboMap_.erase(event.modelUUID);
+        ReleaseModelBuffers(event.modelUUID);
         models_.erase(it);
         if (selectedModelUUID_ == event.modelUUID) {
             selectedModelUUID_.clear();
@@ -48,6 +48,7 @@ private:
     void RemoveTexture(const std::string& textureUUID);
     void AdjustFrameRate(bool isPlaying);
     std::vector<glm::vec3> GenerateGridAndAxesVertices(); // 生成网格和坐标轴顶点
+    void ReleaseModelBuffers(const std::string& modelUUID); // 释放模型的 GPU 缓冲，下次渲染时重新上传
 
     // 事件处理函数
     void OnModelLoaded(const MyRenderer::Events::ModelLoadedEvent& event);
@@ -63,6 +64,7 @@ private:
     void OnAnimationUpdated(const MyRenderer::Events::AnimationUpdatedEvent& event);
     void OnHierarchyUpdate(const MyRenderer::Events::HierarchyUpdateEvent& event);
     void OnSceneLightUpdated(const MyRenderer::Events::SceneLightUpdatedEvent& event); // 处理光照更新事件
+    void OnProceduralChunkReady(const MyRenderer::Events::ProceduralChunkReadyEvent& event); // 程序化生成的分块网格
 
     std::shared_ptr<EventBus> eventBus_;
     std::shared_ptr<ShaderManager> shaderManager_;
@@ -83,6 +85,7 @@ private:
     std::map<std::string, GLuint> vboMap_; // 每个模型的 VBO
     std::map<std::string, GLuint> eboMap_; // 每个模型的 EBO
     std::map<std::string, GLuint> normalVboMap_; // 存储法线 VBO
+    std::map<std::string, GLuint> instanceVboMap_; // 实例化模型的实例变换 VBO
 
     // 相机参数
     glm::mat4 view_ = glm::mat4(1.0f);
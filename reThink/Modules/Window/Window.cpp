@@ -2,6 +2,8 @@
 #include <iostream>
 #include "EventBus/EventTypes.h"
 #include "imgui_internal.h"
+#include "WFCGenerator/WFCGenerator.h"
+#include "LSystemGenerator/LSystemGenerator.h"
 
 namespace MyRenderer {
 
@@ -121,6 +123,8 @@ void Window::Update() {
     // 核心更新逻辑
     inputHandler_->Update();
     textureManager_->ProcessTextureUploadQueue();
+    // 每帧统一分发排队事件（合并后的材质更新、模型变换等）
+    eventBus_->DispatchQueued();
 
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -179,6 +183,10 @@ void Window::Update() {
 
 void Window::Shutdown() {
     if (window_) {
+        // 先取消并等待生成任务，避免其在模块关闭后继续输出网格
+        std::cout << "[清理] 正在停止程序化生成任务..." << std::endl;
+        proceduralJobManager_.reset();
+
         std::cout << "[清理] 正在关闭场景视口..." << std::endl;
         sceneViewport_->Shutdown();
 
@@ -304,7 +312,7 @@ void Window::SubscribeToEvents() {
 void Window::InitializeModules() {
     try {
         std::cout << "[模块] 初始化线程池..." << std::endl;
-        threadPool_ = std::make_shared<ThreadPool>(4);
+        threadPool_ = std::make_shared<ThreadPool>(4, ThreadPool::SchedulingMode::WorkStealing);
         if (!threadPool_) throw std::runtime_error("线程池创建失败");
     } catch (const std::exception& e) {
         std::cerr << "[错误] 线程池初始化失败: " << e.what() << std::endl;
@@ -354,6 +362,7 @@ void Window::InitializeModules() {
         std::cout << "[模块] 初始化模型加载器..." << std::endl;
         modelLoader_ = std::make_shared<ModelLoader>(eventBus_, threadPool_, materialManager_);
         if (!modelLoader_) throw std::runtime_error("模型加载器创建失败");
+        modelLoader_->SetMeshCache(std::make_shared<MeshCache>("Cache/Meshes"));
     } catch (const std::exception& e) {
         std::cerr << "[错误] 模型加载器初始化失败: " << e.what() << std::endl;
         throw;
@@ -424,6 +433,18 @@ void Window::InitializeModules() {
         throw;
     }
 
+    try {
+        std::cout << "[模块] 初始化程序化任务管理器..." << std::endl;
+        proceduralJobManager_ = std::make_shared<ProceduralJobManager>(eventBus_, threadPool_);
+        proceduralJobManager_->RegisterGenerator(std::make_shared<WFCGenerator>(modelLoader_, threadPool_));
+        proceduralJobManager_->RegisterGenerator(std::make_shared<LSystemGenerator>(threadPool_));
+        // 相同参数的生成结果缓存在磁盘上，总大小上限 1 GB
+        proceduralJobManager_->SetCache(std::make_shared<ProceduralCache>("Cache/Procedural", 1024ull * 1024 * 1024));
+    } catch (const std::exception& e) {
+        std::cerr << "[错误] 程序化任务管理器初始化失败: " << e.what() << std::endl;
+        throw;
+    }
+
     try {
         std::cout << "[模块] 初始化动画模块..." << std::endl;
         animation_ = std::make_shared<Animation>(eventBus_);
@@ -28,6 +28,7 @@
 #include "TextureManager/TextureManager.h"
 #include "UndoRedoManager/UndoRedoManager.h"
 #include "AnimationManager/AnimationManager.h"
+#include "ProceduralJobManager/ProceduralJobManager.h"
 // 前向声明所有模块
 namespace MyRenderer {
 
@@ -70,6 +71,7 @@ private:
     std::shared_ptr<ProjectTree> projectTree_;
     std::shared_ptr<InputHandler> inputHandler_;
     std::shared_ptr<ProceduralWindow> proceduralWindow_;
+    std::shared_ptr<ProceduralJobManager> proceduralJobManager_;
     std::shared_ptr<Animation> animation_;
     std::shared_ptr<ProjectManager> projectManager_;
     std::shared_ptr<UndoRedoManager> undoRedoManager_;
@@ -1 +1,30 @@
 ﻿#include "IProceduralGenerator.h"
+
+ProceduralJobContext::ProceduralJobContext(uint64_t jobId, std::shared_ptr<EventBus> eventBus)
+    : jobId_(jobId), eventBus_(eventBus), cancelled_(false), progress_(0.0f), workUnits_(0), recording_(false) {
+    if (!eventBus_) throw std::invalid_argument("ProceduralJobContext: EventBus cannot be null");
+}
+
+void ProceduralJobContext::ReportProgress(float progress) {
+    progress_.store(progress, std::memory_order_relaxed);
+    eventBus_->Enqueue(MyRenderer::Events::ProgressUpdateEvent{progress, jobId_});
+}
+
+void ProceduralJobContext::EmitMesh(ModelData mesh, size_t index, size_t count) {
+    if (recording_.load(std::memory_order_relaxed)) {
+        // 先在锁外复制网格，并发输出的各块只在追加时互斥
+        ProceduralMeshChunk chunk{mesh, index, count};
+        std::lock_guard<std::mutex> lock(recordMutex_);
+        recorded_.push_back(std::move(chunk));
+    }
+    eventBus_->Enqueue(MyRenderer::Events::ProceduralChunkReadyEvent{std::move(mesh), index, count, jobId_});
+}
+
+void ProceduralJobContext::SetRecording(bool recording) {
+    recording_ = recording;
+}
+
+std::vector<ProceduralMeshChunk> ProceduralJobContext::TakeRecordedMeshes() {
+    std::lock_guard<std::mutex> lock(recordMutex_);
+    return std::move(recorded_);
+}
\ No newline at end of file
@@ -1,29 +1,131 @@
 ﻿#pragma once
 #include <string>
+#include <mutex>
+#include <any>
+#include <vector>
 #include <memory>
+#include <atomic>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 #include "EventBus/EventBus.h"
 #include "EventBus/EventTypes.h"
+#include "ThreadPool/ThreadPool.h"
+
+/**
+ * @brief 生成器输出的一块网格及其在本次输出中的序号。
+ */
+struct ProceduralMeshChunk {
+    ModelData mesh;
+    size_t index = 0;
+    size_t count = 0;
+};
+
+/**
+ * @brief 一次程序化生成任务的运行上下文，由 ProceduralJobManager 创建并传给生成器。
+ *
+ * 生成器通过它报告进度、输出网格并检查取消请求，入队的事件都带有任务 ID，由主线程统一分发。
+ * 取消是协作式的：生成器应在各阶段之间以及耗时循环中检查 IsCancelled()。
+ * 除构造外的成员函数都可以在任意线程并发调用。
+ */
+class ProceduralJobContext {
+public:
+    ProceduralJobContext(uint64_t jobId, std::shared_ptr<EventBus> eventBus);
+
+    uint64_t GetJobId() const { return jobId_; }
+
+    bool IsCancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+    // 取消标志，供接受 const std::atomic<bool>* 的求解器直接轮询
+    const std::atomic<bool>* GetCancellationFlag() const { return &cancelled_; }
+
+    void Cancel() { cancelled_ = true; }
+
+    /**
+     * @brief 记录进度（0.0 到 1.0）并将进度事件入队。
+     */
+    void ReportProgress(float progress);
+
+    float GetProgress() const { return progress_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 累计已完成的工作量，单位由生成器的 GetWorkUnitName() 给出，用于统计吞吐量。
+     */
+    void AddWorkUnits(uint64_t units) { workUnits_.fetch_add(units, std::memory_order_relaxed); }
+    uint64_t GetWorkUnits() const { return workUnits_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 输出一块网格，入队后由主线程统一分发，视口在主线程上传 GPU 缓冲。
+     */
+    void EmitMesh(ModelData mesh, size_t index, size_t count);
+
+    /**
+     * @brief 开启后 EmitMesh 额外保留一份网格副本，用于写入结果缓存。
+     */
+    void SetRecording(bool recording);
+
+    /**
+     * @brief 取出已记录的网格，按输出的先后顺序排列。
+     */
+    std::vector<ProceduralMeshChunk> TakeRecordedMeshes();
+
+    /**
+     * @brief 保存 / 读取生成器在 Prepare 中得到的结果，只由同一任务的 Prepare 与 Generate 先后访问。
+     */
+    void SetPreparedData(std::any data) { preparedData_ = std::move(data); }
+    const std::any& GetPreparedData() const { return preparedData_; }
+
+private:
+    const uint64_t jobId_;
+    std::shared_ptr<EventBus> eventBus_;
+    std::atomic<bool> cancelled_;
+    std::atomic<float> progress_;
+    std::atomic<uint64_t> workUnits_;
+    std::atomic<bool> recording_;
+    std::mutex recordMutex_;
+    std::vector<ProceduralMeshChunk> recorded_;
+    std::any preparedData_;
+};
 
 class IProceduralGenerator {
 public:
     virtual ~IProceduralGenerator() = default;
 
     /**
-     * @brief 执行程序化生成任务。
+     * @brief 在调用线程上同步执行一次程序化生成，同一实例可被多个任务并发调用。
      * @param params 生成参数（JSON 格式）。
-     * @param eventBus 事件总线，用于发布生成相关事件。
+     * @param context 任务上下文，用于报告进度、输出网格与检查取消。
+     * @return 生成结果的根节点，网格通过 context.EmitMesh 输出；被取消时返回值会被忽略。
+     * @throws std::exception 参数无效或生成失败时抛出，异常信息作为失败原因。
      */
-    virtual void Generate(const nlohmann::json& params, std::shared_ptr<EventBus> eventBus) = 0;
+    virtual ModelData Generate(const nlohmann::json& params, ProceduralJobContext& context) = 0;
 
     /**
-     * @brief 取消当前生成任务。
+     * @brief 生成前的准备阶段，在工作线程上调用，不得阻塞等待其他线程池任务。
+     *
+     * 依赖其他线程池任务（如加载模型）的生成器在这里发起这些任务，并通过 context.SetPreparedData 保存；
+     * 返回的任务全部完成后才调用 Generate，此时读取结果不会阻塞。
+     * @return 需要先完成的任务，默认为空。
      */
-    virtual void Cancel() = 0;
+    virtual std::vector<ThreadPool::TaskHandle> Prepare(const nlohmann::json& params, ProceduralJobContext& context) { return {}; }
 
     /**
      * @brief 获取算法名称。
      * @return 算法的唯一名称。
      */
     virtual std::string GetName() const = 0;
+
+    /**
+     * @brief 生成器版本，相同参数的输出发生变化时递增，使已缓存的结果失效。
+     */
+    virtual uint32_t GetVersion() const { return 1; }
+
+    /**
+     * @brief 生成结果依赖的外部文件，文件改变时已缓存的结果失效。
+     */
+    virtual std::vector<std::string> GetInputFiles(const nlohmann::json& params) const { return {}; }
+
+    /**
+     * @brief 工作量的单位名称，如 "cells"、"symbols"。
+     */
+    virtual std::string GetWorkUnitName() const { return "units"; }
 };
\ No newline at end of file
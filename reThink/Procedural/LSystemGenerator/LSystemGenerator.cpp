@@ -1,52 +1,55 @@
 ﻿#include "LSystemGenerator.h"
+#include "LSystemMesher.h"
 #include <chrono>
+#include <iostream>
+#include <algorithm>
 #include "Utils/MathUtils.h"
 
-LSystemGenerator::LSystemGenerator() : cancelled_(false) {}
-
-LSystemGenerator::~LSystemGenerator() {
-    if (generationThread_.joinable()) {
-        Cancel();
-        generationThread_.join();
-    }
-}
-
-void LSystemGenerator::Generate(const nlohmann::json& params, std::shared_ptr<EventBus> eventBus) {
-    cancelled_ = false;
-    if (generationThread_.joinable()) {
-        generationThread_.join();
-    }
-    generationThread_ = std::thread(&LSystemGenerator::RunGeneration, this, params, eventBus);
+namespace {
+    // 海龟解释时每处理这么多符号检查一次取消并更新进度，也是流式读取的缓冲大小
+    constexpr size_t kInterpretBlockSize = 1 << 20;
+    // 实例化解释时每处理这么多个顶层符号检查一次取消并更新进度
+    constexpr size_t kProgressInterval = 4096;
 }
 
-void LSystemGenerator::Cancel() {
-    cancelled_ = true;
+LSystemGenerator::LSystemGenerator(std::shared_ptr<ThreadPool> threadPool) : threadPool_(threadPool) {
+    if (!threadPool_) throw std::invalid_argument("LSystemGenerator: ThreadPool cannot be null");
 }
 
-void LSystemGenerator::RunGeneration(const nlohmann::json& params, std::shared_ptr<EventBus> eventBus) {
-    eventBus->Publish(MyRenderer::Events::ProceduralGenerationStartedEvent{});
-
-    int iterations = params.value("iterations", 3);
+ModelData LSystemGenerator::Generate(const nlohmann::json& params, ProceduralJobContext& context) {
+    std::string axiom = params.value("axiom", std::string("F"));
+    nlohmann::json rules = params.value("rules", nlohmann::json("F[+F]F[-F]F"));
+    int iterations = params.value("iterations", 5);
+    float angle = params.value("angle", 25.7f);
     float length = params.value("length", 1.0f);
-    float angle = params.value("angle", 30.0f);
+    size_t memoryBudget = static_cast<size_t>(std::max(params.value("memoryBudgetMB", 512), 1)) * 1024 * 1024;
+    bool streaming = params.value("streaming", true);
+    bool instancing = params.value("instancing", false);
+    uint32_t seed = params.value("seed", 0u);
+    uint32_t variants = static_cast<uint32_t>(std::max(params.value("variants", 4), 1));
+    LSystemMesher::Options meshOptions;
+    meshOptions.radius = params.value("radius", 0.1f);
+    meshOptions.radiusFalloff = params.value("radiusFalloff", 0.7f);
+    meshOptions.maxSides = params.value("maxSides", 8);
 
-    ModelData modelData = GenerateTree(iterations, length, angle);
+    // 文法无效时抛出 std::invalid_argument，由任务管理器作为失败原因报告
+    LSystemGrammar grammar(rules, seed, variants);
 
-    for (int i = 0; i <= 100; i += 10) {
-        if (cancelled_) {
-            eventBus->Publish(MyRenderer::Events::ProceduralGenerationStoppedEvent{});
-            return;
-        }
-        eventBus->Publish(MyRenderer::Events::ProgressUpdateEvent{static_cast<float>(i) / 100.0f});
-        std::this_thread::sleep_for(std::chrono::milliseconds(100)); // 模拟耗时
+    LSystemTurtle turtle(angle, length);
+    std::map<uint64_t, Prototype> prototypes;
+    bool interpreted;
+    if (instancing && iterations >= 2) {
+        interpreted = InterpretInstanced(grammar, axiom, iterations, memoryBudget, angle, length, turtle, prototypes, context);
+    } else if (streaming) {
+        interpreted = InterpretStreamed(grammar, axiom, iterations, turtle, context);
+    } else {
+        interpreted = InterpretExpanded(grammar, axiom, iterations, memoryBudget, turtle, context);
     }
+    if (!interpreted) return ModelData{};
+    // 工作量按完整展开后的符号数计，与解释方式无关
+    context.AddWorkUnits(grammar.ExpandedLength(axiom, iterations));
 
-    if (!cancelled_) {
-        eventBus->Publish(MyRenderer::Events::ProceduralGenerationCompletedEvent{true, "", modelData});
-    }
-}
-
-ModelData LSystemGenerator::GenerateTree(int iterations, float length, float angle) {
+    // 结果本身不含几何数据，枝干网格与各原型的实例网格通过 ProceduralChunkReadyEvent 输出
     ModelData modelData;
     modelData.uuid = "lsystem_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
     modelData.filepath = "";
@@ -55,23 +58,118 @@ ModelData LSystemGenerator::GenerateTree(int iterations, float length, float ang
     modelData.fragmentShaderPath = "";
     modelData.parentUUID = "";
 
-    std::vector<glm::vec3> vertices;
-    BuildBranch(vertices, glm::vec3(0, 0, 0), length, angle, iterations);
-    modelData.vertices = vertices;
+    std::vector<ModelData> models;
+    models.push_back(LSystemMesher::Build(turtle.GetSegments(), meshOptions, *threadPool_));
+    for (auto& [key, prototype] : prototypes) {
+        if (!prototype.valid || prototype.segments.empty() || prototype.instances.empty()) continue;
+        for (auto& segment : prototype.segments) {
+            segment.depth += prototype.baseDepth;
+        }
+        ModelData model = LSystemMesher::Build(prototype.segments, meshOptions, *threadPool_);
+        model.vertexShaderPath = "Shaders/instanced.vs";
+        model.instanceTransforms = std::move(prototype.instances);
+        models.push_back(std::move(model));
+    }
+    models.erase(std::remove_if(models.begin(), models.end(), [](const ModelData& model) { return model.vertices.empty(); }), models.end());
 
+    if (context.IsCancelled()) return modelData;
+    for (size_t i = 0; i < models.size(); ++i) {
+        models[i].uuid = modelData.uuid + "_chunk_" + std::to_string(i);
+        models[i].parentUUID = modelData.uuid;
+        context.EmitMesh(std::move(models[i]), i, models.size());
+    }
     return modelData;
 }
 
-void LSystemGenerator::BuildBranch(std::vector<glm::vec3>& vertices, glm::vec3 pos, float length, float angle, int depth) {
-    if (depth <= 0) return;
+bool LSystemGenerator::InterpretExpanded(const LSystemGrammar& grammar, const std::string& axiom, int iterations, size_t memoryBudget,
+                                         LSystemTurtle& turtle, ProceduralJobContext& context) {
+    // 进度：重写占前一半，海龟解释占随后的 40%
+    LSystemGrammar::Expansion expansion = grammar.Expand(axiom, iterations, *threadPool_, memoryBudget, context.GetCancellationFlag(),
+        [&](int generation, size_t) {
+            context.ReportProgress(0.5f * generation / std::max(iterations, 1));
+        });
+    if (context.IsCancelled()) return false;
+    if (expansion.truncated) {
+        std::cerr << "[LSystemGenerator] 超出内存预算，仅展开到第 " << expansion.iterations << " 代" << std::endl;
+    }
 
-    vertices.push_back(pos);
-    glm::vec3 dir = glm::vec3(0, 1, 0); // 初始向上
-    pos += dir * length;
-    vertices.push_back(pos);
+    const size_t symbolCount = expansion.symbols.size();
+    for (size_t begin = 0; begin < symbolCount; begin += kInterpretBlockSize) {
+        if (context.IsCancelled()) return false;
+        size_t count = std::min(kInterpretBlockSize, symbolCount - begin);
+        turtle.Interpret(expansion.symbols.data() + begin, count);
+        context.ReportProgress(0.5f + 0.4f * (begin + count) / symbolCount);
+    }
+    return true;
+}
+
+bool LSystemGenerator::InterpretStreamed(const LSystemGrammar& grammar, const std::string& axiom, int iterations,
+                                         LSystemTurtle& turtle, ProceduralJobContext& context) {
+    // 总长度由递推得到，无需展开即可按已读取的比例报告进度
+    const double symbolCount = static_cast<double>(std::max<uint64_t>(grammar.ExpandedLength(axiom, iterations), 1));
+    LSystemGrammar::Cursor cursor(grammar, axiom, iterations);
+    std::vector<uint8_t> buffer(kInterpretBlockSize);
+    uint64_t consumed = 0;
+    while (size_t count = cursor.Read(buffer.data(), buffer.size())) {
+        if (context.IsCancelled()) return false;
+        turtle.Interpret(buffer.data(), count);
+        consumed += count;
+        context.ReportProgress(static_cast<float>(0.9 * consumed / symbolCount));
+    }
+    return !context.IsCancelled();
+}
+
+bool LSystemGenerator::InterpretInstanced(const LSystemGrammar& grammar, const std::string& axiom, int iterations, size_t memoryBudget,
+                                          float angle, float length, LSystemTurtle& turtle, std::map<uint64_t, Prototype>& prototypes,
+                                          ProceduralJobContext& context) {
+    // 前一半代数完整展开，超出内存预算时展开得更少，剩余代数全部由原型承担
+    LSystemGrammar::Expansion top = grammar.Expand(axiom, iterations - iterations / 2, *threadPool_, memoryBudget, context.GetCancellationFlag());
+    if (context.IsCancelled()) return false;
+    const int prototypeGenerations = iterations - top.iterations;
+    context.ReportProgress(0.2f);
+
+    std::vector<uint8_t> buffer(kInterpretBlockSize);
+    auto interpretSubtree = [&](LSystemTurtle& target, uint8_t symbol, uint32_t variant) {
+        LSystemGrammar::Cursor cursor(grammar, symbol, variant, prototypeGenerations);
+        while (size_t count = cursor.Read(buffer.data(), buffer.size())) {
+            target.Interpret(buffer.data(), count);
+        }
+    };
 
-    glm::mat4 rot1 = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0, 0, 1));
-    glm::mat4 rot2 = glm::rotate(glm::mat4(1.0f), glm::radians(-angle), glm::vec3(0, 0, 1));
-    BuildBranch(vertices, pos, length * 0.7f, angle, depth - 1);
-    BuildBranch(vertices, pos, length * 0.7f, angle, depth - 1);
+    const size_t symbolCount = top.symbols.size();
+    for (size_t i = 0; i < symbolCount; ++i) {
+        if (i % kProgressInterval == 0) {
+            if (context.IsCancelled()) return false;
+            context.ReportProgress(0.2f + 0.7f * i / symbolCount);
+        }
+        uint8_t symbol = top.symbols[i];
+        if (!grammar.HasProduction(symbol)) {
+            turtle.Consume(symbol);
+            continue;
+        }
+
+        uint32_t variant = top.variants.empty() ? 0 : top.variants[i];
+        uint64_t key = (static_cast<uint64_t>(symbol) << 56) | (static_cast<uint64_t>(turtle.GetStackDepth()) << 32) | variant;
+        auto [it, inserted] = prototypes.try_emplace(key);
+        Prototype& prototype = it->second;
+        if (inserted) {
+            LSystemTurtle local(angle, length);
+            interpretSubtree(local, symbol, variant);
+            prototype.valid = !local.HasUnderflow() && local.GetStackDepth() == 0;
+            prototype.baseDepth = static_cast<uint32_t>(turtle.GetStackDepth());
+            prototype.relative = local.GetState();
+            if (prototype.valid) prototype.segments = local.TakeSegments();
+        }
+        if (!prototype.valid) {
+            interpretSubtree(turtle, symbol, variant);
+            continue;
+        }
+
+        // 初始状态的 H、L、U 为 +Y、-X、+Z，实例变换把它们映射到当前状态
+        const LSystemTurtle::State& state = turtle.GetState();
+        prototype.instances.push_back(glm::mat4(glm::vec4(-state.left, 0.0f), glm::vec4(state.heading, 0.0f),
+                                                glm::vec4(state.up, 0.0f), glm::vec4(state.position, 1.0f)));
+        turtle.Advance(prototype.relative);
+    }
+    return !context.IsCancelled();
 }
\ No newline at end of file
@@ -1,23 +1,41 @@
 ﻿#pragma once
 #include "IProceduralGenerator/IProceduralGenerator.h"
+#include "ThreadPool/ThreadPool.h"
+#include "LSystemGrammar.h"
+#include "LSystemTurtle.h"
+#include <map>
 #include <vector>
-#include <atomic>
-#include <thread>
 
 class LSystemGenerator : public IProceduralGenerator {
 public:
-    LSystemGenerator();
-    ~LSystemGenerator() override;
+    explicit LSystemGenerator(std::shared_ptr<ThreadPool> threadPool);
 
-    void Generate(const nlohmann::json& params, std::shared_ptr<EventBus> eventBus) override;
-    void Cancel() override;
+    ModelData Generate(const nlohmann::json& params, ProceduralJobContext& context) override;
     std::string GetName() const override { return "LSystem"; }
+    std::string GetWorkUnitName() const override { return "symbols"; }
 
 private:
-    void RunGeneration(const nlohmann::json& params, std::shared_ptr<EventBus> eventBus);
-    ModelData GenerateTree(int iterations, float length, float angle);
-    void BuildBranch(std::vector<glm::vec3>& vertices, glm::vec3 pos, float length, float angle, int depth);
+    /**
+     * @brief 以实例方式输出的子树原型，由 (符号, 变体, 所在分支深度) 唯一确定。
+     */
+    struct Prototype {
+        bool valid = false;                            // 子树内括号是否配平，不配平时无法作为整体跳过
+        uint32_t baseDepth = 0;                        // 子树根所在的分支深度
+        LSystemTurtle::State relative{};               // 从初始状态解释子树后的海龟状态
+        std::vector<LSystemTurtle::Segment> segments;  // 以初始状态为原点的线段
+        std::vector<glm::mat4> instances;              // 各次出现时的海龟坐标系
+    };
 
-    std::atomic<bool> cancelled_;
-    std::thread generationThread_;
+    // 先完整展开再解释，展开阶段并行但需要保存整个符号串；被取消时返回 false
+    bool InterpretExpanded(const LSystemGrammar& grammar, const std::string& axiom, int iterations, size_t memoryBudget,
+                           LSystemTurtle& turtle, ProceduralJobContext& context);
+    // 通过深度优先游标边展开边解释，工作内存只与迭代次数有关；被取消时返回 false
+    bool InterpretStreamed(const LSystemGrammar& grammar, const std::string& axiom, int iterations,
+                           LSystemTurtle& turtle, ProceduralJobContext& context);
+    // 只展开前一部分代数，其余代数展开出的子树各生成一次并记录为原型实例；被取消时返回 false
+    bool InterpretInstanced(const LSystemGrammar& grammar, const std::string& axiom, int iterations, size_t memoryBudget,
+                            float angle, float length, LSystemTurtle& turtle, std::map<uint64_t, Prototype>& prototypes,
+                            ProceduralJobContext& context);
+
+    std::shared_ptr<ThreadPool> threadPool_;
 };
\ No newline at end of file
@@ -0,0 +1,298 @@
+﻿#include "LSystemGrammar.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <limits>
+
+namespace {
+    // 每个并行块处理的符号数量
+    constexpr size_t kExpandBlockSize = 1 << 16;
+
+    std::string Trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) return "";
+        size_t last = text.find_last_not_of(" \t\r\n");
+        return text.substr(first, last - first + 1);
+    }
+
+    uint64_t SaturatingAdd(uint64_t a, uint64_t b) {
+        return a > std::numeric_limits<uint64_t>::max() - b ? std::numeric_limits<uint64_t>::max() : a + b;
+    }
+
+    // splitmix64 的混合函数
+    uint64_t Mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+}
+
+LSystemGrammar::LSystemGrammar(const nlohmann::json& rules, uint32_t seed, uint32_t variantCount)
+    : seed_(seed), variantCount_(std::max(variantCount, 1u)) {
+    if (rules.is_object()) {
+        for (auto& [symbol, production] : rules.items()) {
+            if (!production.is_array()) {
+                AddProduction(symbol, production.get<std::string>(), 1.0f);
+                continue;
+            }
+            for (const auto& alternative : production) {
+                if (alternative.is_array() && alternative.size() == 2) {
+                    AddProduction(symbol, alternative[1].get<std::string>(), alternative[0].get<float>());
+                } else {
+                    AddProduction(symbol, alternative.get<std::string>(), 1.0f);
+                }
+            }
+        }
+    } else if (rules.is_string()) {
+        std::string text = rules.get<std::string>();
+        if (text.find('=') == std::string::npos) {
+            // 只有右部时视为 F 的产生式
+            if (!Trim(text).empty()) AddProduction("F", text, 1.0f);
+        } else {
+            size_t start = 0;
+            while (start <= text.size()) {
+                size_t end = text.find_first_of(";\n", start);
+                if (end == std::string::npos) end = text.size();
+                std::string rule = Trim(text.substr(start, end - start));
+                start = end + 1;
+                if (rule.empty()) continue;
+                size_t equals = rule.find('=');
+                if (equals == std::string::npos) {
+                    throw std::invalid_argument("LSystemGrammar: Rule without '=': " + rule);
+                }
+                std::string successor = Trim(rule.substr(equals + 1));
+                float weight = 1.0f;
+                if (!successor.empty() && successor[0] == '(') {
+                    size_t close = successor.find(')');
+                    try {
+                        if (close == std::string::npos) throw std::invalid_argument(successor);
+                        weight = std::stof(successor.substr(1, close - 1));
+                    } catch (const std::exception&) {
+                        throw std::invalid_argument("LSystemGrammar: Malformed rule weight: " + rule);
+                    }
+                    successor = successor.substr(close + 1);
+                }
+                AddProduction(Trim(rule.substr(0, equals)), successor, weight);
+            }
+        }
+    } else if (!rules.is_null()) {
+        throw std::invalid_argument("LSystemGrammar: Rules must be a string or an object");
+    }
+
+    // 权重归一化为累计值，便于按均匀随机数选择
+    for (size_t symbol = 0; symbol < productions_.size(); ++symbol) {
+        auto& alternatives = productions_[symbol];
+        outputLength_[symbol] = alternatives.empty() ? 1 : static_cast<uint32_t>(alternatives[0].successor.size());
+        if (alternatives.size() < 2) continue;
+        stochastic_ = true;
+        float total = 0.0f;
+        for (const auto& alternative : alternatives) total += alternative.weight;
+        if (!(total > 0.0f)) {
+            throw std::invalid_argument("LSystemGrammar: Rule weights must sum to a positive value");
+        }
+        float cumulative = 0.0f;
+        for (auto& alternative : alternatives) {
+            cumulative += alternative.weight / total;
+            alternative.weight = cumulative;
+        }
+    }
+    if (!stochastic_) variantCount_ = 1;
+}
+
+void LSystemGrammar::AddProduction(const std::string& symbol, const std::string& production, float weight) {
+    if (symbol.size() != 1) {
+        throw std::invalid_argument("LSystemGrammar: Rule predecessor must be a single symbol: " + symbol);
+    }
+    if (weight < 0.0f) {
+        throw std::invalid_argument("LSystemGrammar: Rule weight must not be negative: " + symbol);
+    }
+    // 产生式中的空白不是符号
+    std::string compact;
+    for (char c : production) {
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') compact.push_back(c);
+    }
+    uint8_t code = static_cast<uint8_t>(symbol[0]);
+    productions_[code].push_back({std::move(compact), weight});
+    hasProduction_[code] = 1;
+}
+
+const std::string& LSystemGrammar::Select(uint8_t symbol, uint32_t variant) const {
+    const auto& alternatives = productions_[symbol];
+    if (alternatives.size() == 1) return alternatives[0].successor;
+    uint64_t hash = Mix(Mix(seed_ ^ (static_cast<uint64_t>(symbol) << 32)) ^ variant);
+    float r = static_cast<float>(hash >> 40) * (1.0f / 16777216.0f);
+    for (const auto& alternative : alternatives) {
+        if (r < alternative.weight) return alternative.successor;
+    }
+    return alternatives.back().successor;
+}
+
+uint32_t LSystemGrammar::ChildVariant(uint32_t parentVariant, size_t index) const {
+    if (variantCount_ == 1) return 0;
+    uint64_t hash = Mix(Mix((static_cast<uint64_t>(seed_) << 32) ^ parentVariant) ^ index);
+    return static_cast<uint32_t>(hash % variantCount_);
+}
+
+LSystemGrammar::Expansion LSystemGrammar::Expand(const std::string& axiom, int iterations, ThreadPool& threadPool, size_t memoryBudget,
+                                                 const std::atomic<bool>* cancelled,
+                                                 const std::function<void(int, size_t)>& onGeneration) const {
+    Expansion result;
+    std::vector<uint8_t> current(axiom.begin(), axiom.end());
+    std::vector<uint8_t> next;
+    std::vector<uint32_t> currentVariants;
+    std::vector<uint32_t> nextVariants;
+    std::vector<size_t> offsets;
+    // 随机文法需要同时保存每个符号的变体
+    const size_t bytesPerSymbol = stochastic_ ? 1 + sizeof(uint32_t) : 1;
+    if (stochastic_) {
+        currentVariants.resize(current.size());
+        for (size_t i = 0; i < current.size(); ++i) {
+            currentVariants[i] = ChildVariant(0, i);
+        }
+    }
+
+    for (int generation = 0; generation < iterations; ++generation) {
+        if (cancelled && *cancelled) break;
+
+        // 第一遍：各块统计输出长度，前缀和得到各块的写入偏移
+        const size_t count = current.size();
+        const size_t blockCount = (count + kExpandBlockSize - 1) / kExpandBlockSize;
+        offsets.assign(blockCount + 1, 0);
+        threadPool.ParallelFor(0, blockCount, 1, [&](size_t block) {
+            size_t begin = block * kExpandBlockSize;
+            size_t end = std::min(begin + kExpandBlockSize, count);
+            size_t length = 0;
+            if (stochastic_) {
+                for (size_t i = begin; i < end; ++i) {
+                    length += hasProduction_[current[i]] ? Select(current[i], currentVariants[i]).size() : 1;
+                }
+            } else {
+                for (size_t i = begin; i < end; ++i) {
+                    length += outputLength_[current[i]];
+                }
+            }
+            offsets[block + 1] = length;
+        });
+        for (size_t block = 0; block < blockCount; ++block) {
+            offsets[block + 1] += offsets[block];
+        }
+        const size_t total = offsets[blockCount];
+        if ((count + total) * bytesPerSymbol > memoryBudget) {
+            result.truncated = true;
+            break;
+        }
+
+        // 第二遍：一次性分配输出，各块写入互不重叠的区间
+        next.resize(total);
+        if (stochastic_) nextVariants.resize(total);
+        threadPool.ParallelFor(0, blockCount, 1, [&](size_t block) {
+            size_t begin = block * kExpandBlockSize;
+            size_t end = std::min(begin + kExpandBlockSize, count);
+            size_t out = offsets[block];
+            for (size_t i = begin; i < end; ++i) {
+                uint8_t symbol = current[i];
+                if (!hasProduction_[symbol]) {
+                    if (stochastic_) nextVariants[out] = currentVariants[i];
+                    next[out++] = symbol;
+                    continue;
+                }
+                uint32_t variant = stochastic_ ? currentVariants[i] : 0;
+                const std::string& production = Select(symbol, variant);
+                if (production.empty()) continue;
+                std::memcpy(next.data() + out, production.data(), production.size());
+                if (stochastic_) {
+                    for (size_t k = 0; k < production.size(); ++k) {
+                        nextVariants[out + k] = ChildVariant(variant, k);
+                    }
+                }
+                out += production.size();
+            }
+        });
+        current.swap(next);
+        currentVariants.swap(nextVariants);
+        result.iterations = generation + 1;
+        if (onGeneration) onGeneration(result.iterations, current.size());
+    }
+
+    result.symbols = std::move(current);
+    result.variants = std::move(currentVariants);
+    return result;
+}
+
+uint64_t LSystemGrammar::ExpandedLength(const std::string& axiom, int iterations) const {
+    // length[symbol * variantCount_ + variant] 为该符号实例经过 generation 代重写后的长度，逐代递推
+    const size_t stateCount = productions_.size() * variantCount_;
+    std::vector<uint64_t> length(stateCount, 1);
+    std::vector<uint64_t> next(stateCount, 1);
+    for (int generation = 0; generation < iterations; ++generation) {
+        for (size_t symbol = 0; symbol < productions_.size(); ++symbol) {
+            if (!hasProduction_[symbol]) continue;
+            for (uint32_t variant = 0; variant < variantCount_; ++variant) {
+                const std::string& production = Select(static_cast<uint8_t>(symbol), variant);
+                uint64_t total = 0;
+                for (size_t k = 0; k < production.size(); ++k) {
+                    size_t child = static_cast<uint8_t>(production[k]) * variantCount_ + ChildVariant(variant, k);
+                    total = SaturatingAdd(total, length[child]);
+                }
+                next[symbol * variantCount_ + variant] = total;
+            }
+        }
+        length.swap(next);
+    }
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < axiom.size(); ++i) {
+        size_t state = static_cast<uint8_t>(axiom[i]) * variantCount_ + ChildVariant(0, i);
+        total = SaturatingAdd(total, length[state]);
+    }
+    return total;
+}
+
+LSystemGrammar::Cursor::Cursor(const LSystemGrammar& grammar, const std::string& axiom, int iterations)
+    : grammar_(grammar), axiom_(axiom), iterations_(std::max(iterations, 0)) {
+    stack_.reserve(static_cast<size_t>(iterations_) + 1);
+    stack_.push_back({reinterpret_cast<const uint8_t*>(axiom_.data()), axiom_.size(), 0, 0, 0});
+}
+
+LSystemGrammar::Cursor::Cursor(const LSystemGrammar& grammar, uint8_t symbol, uint32_t variant, int iterations)
+    : grammar_(grammar), axiom_(1, static_cast<char>(symbol)), iterations_(std::max(iterations, 0)) {
+    stack_.reserve(static_cast<size_t>(iterations_) + 1);
+    if (iterations_ > 0 && grammar_.HasProduction(symbol)) {
+        const std::string& production = grammar_.Select(symbol, variant);
+        stack_.push_back({reinterpret_cast<const uint8_t*>(production.data()), production.size(), 0, 1, variant});
+    } else {
+        // 不再重写的符号原样输出
+        stack_.push_back({reinterpret_cast<const uint8_t*>(axiom_.data()), axiom_.size(), 0, iterations_, variant});
+    }
+}
+
+size_t LSystemGrammar::Cursor::Read(uint8_t* buffer, size_t capacity) {
+    size_t count = 0;
+    while (count < capacity && !stack_.empty()) {
+        Frame& frame = stack_.back();
+        if (frame.position == frame.size) {
+            stack_.pop_back();
+            continue;
+        }
+        if (frame.generation == iterations_) {
+            // 最后一代的符号不再重写，整段复制
+            size_t run = std::min(frame.size - frame.position, capacity - count);
+            std::memcpy(buffer + count, frame.data + frame.position, run);
+            frame.position += run;
+            count += run;
+            continue;
+        }
+        size_t index = frame.position++;
+        uint8_t symbol = frame.data[index];
+        if (grammar_.hasProduction_[symbol]) {
+            uint32_t variant = grammar_.ChildVariant(frame.variant, index);
+            const std::string& production = grammar_.Select(symbol, variant);
+            int generation = frame.generation + 1;
+            stack_.push_back({reinterpret_cast<const uint8_t*>(production.data()), production.size(), 0, generation, variant});
+        } else {
+            buffer[count++] = symbol;
+        }
+    }
+    return count;
+}
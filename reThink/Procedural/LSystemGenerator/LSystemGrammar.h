@@ -0,0 +1,129 @@
+﻿#pragma once
+#include <array>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include "ThreadPool/ThreadPool.h"
+
+/**
+ * @brief L 系统文法与并行重写引擎。
+ *
+ * 每个符号编码为一个字节，产生式按符号字节直接索引，重写时无需查找或分配字符串。
+ * 产生式支持以下写法：
+ * - 字符串 "F=FF;X=F[+X]F[-X]+X"：以 ';' 或换行分隔的多条产生式；
+ * - 不含 '=' 的字符串 "F[+F]F[-F]F"：视为 F 的产生式；
+ * - 对象 { "F": "FF", "X": "F[+X]F[-X]+X" }。
+ * 没有产生式的符号在重写时保持不变。
+ *
+ * 同一符号有多条产生式时为随机文法，字符串写法中右部可以带权重前缀 "F=(0.7)F[+F]F;F=(0.3)F[-F]F"，
+ * 对象写法中值为数组，元素为右部字符串或 [权重, 右部]，未给出的权重为 1。
+ * 随机选择不依赖符号在串中的位置：每个符号实例带有一个变体编号，由父实例的变体编号与它在
+ * 产生式中的下标经种子哈希得到，选择哪条产生式只由 (种子, 符号, 变体) 决定。变体数量有限，
+ * 因此相同 (符号, 剩余代数, 变体) 的子树完全相同，可以只生成一次。确定性文法的变体恒为 0。
+ *
+ * 每一代的展开分两遍并行完成：先按块统计输出长度并做前缀和得到各块的写入偏移，
+ * 再一次性分配输出缓冲、各块独立写入。任意时刻只保留相邻两代的缓冲，
+ * 两者之和超过内存预算时停止在最后一个完整的代。
+ *
+ * 也可以通过 Cursor 按深度优先顺序惰性地读取展开结果，不生成完整的符号串。
+ */
+class LSystemGrammar {
+public:
+    /**
+     * @brief 展开结果。
+     */
+    struct Expansion {
+        std::vector<uint8_t> symbols;   // 展开后的符号序列
+        std::vector<uint32_t> variants; // 各符号的变体编号，仅随机文法非空
+        int iterations = 0;             // 实际完成的代数
+        bool truncated = false;         // 是否因内存预算提前停止
+    };
+
+    /**
+     * @brief 深度优先的惰性展开游标，按顺序产出 iterations 代后的符号。
+     *
+     * 栈中每层记录正在读取的产生式及位置，层数不超过 iterations + 1，
+     * 工作内存与展开后的长度无关。游标引用所属文法，使用期间文法须保持有效。
+     */
+    class Cursor {
+    public:
+        Cursor(const LSystemGrammar& grammar, const std::string& axiom, int iterations);
+        /**
+         * @brief 从变体为 variant 的单个符号开始展开，即该符号实例对应的子树。
+         */
+        Cursor(const LSystemGrammar& grammar, uint8_t symbol, uint32_t variant, int iterations);
+        Cursor(const Cursor&) = delete;
+        Cursor& operator=(const Cursor&) = delete;
+
+        /**
+         * @brief 读取至多 capacity 个符号到 buffer。
+         * @return 实际读取的数量，返回 0 表示已全部读完。
+         */
+        size_t Read(uint8_t* buffer, size_t capacity);
+
+    private:
+        struct Frame {
+            const uint8_t* data;
+            size_t size;
+            size_t position;
+            int generation;   // 该层符号所处的代数，公理为 0
+            uint32_t variant; // 被重写为该层的符号实例的变体，公理层为 0
+        };
+
+        const LSystemGrammar& grammar_;
+        std::string axiom_;
+        int iterations_;
+        std::vector<Frame> stack_;
+    };
+
+    /**
+     * @param seed 随机文法的种子。
+     * @param variantCount 每个符号实例可取的变体数量，越小子树复用越多、形态越单一。
+     */
+    explicit LSystemGrammar(const nlohmann::json& rules, uint32_t seed = 0, uint32_t variantCount = 1);
+
+    bool HasProduction(uint8_t symbol) const { return hasProduction_[symbol] != 0; }
+    bool IsStochastic() const { return stochastic_; }
+
+    /**
+     * @brief 变体为 variant 的符号实例所使用的右部，符号须有产生式。
+     */
+    const std::string& Select(uint8_t symbol, uint32_t variant) const;
+
+    /**
+     * @brief 变体为 parentVariant 的实例重写后，右部第 index 个符号的变体。
+     */
+    uint32_t ChildVariant(uint32_t parentVariant, size_t index) const;
+
+    /**
+     * @brief 对公理重写 iterations 代。
+     * @param memoryBudget 相邻两代符号缓冲之和的上限（字节）。
+     * @param onGeneration 可选回调，每完成一代调用一次，参数为已完成的代数与当前长度。
+     */
+    Expansion Expand(const std::string& axiom, int iterations, ThreadPool& threadPool, size_t memoryBudget,
+                     const std::atomic<bool>* cancelled = nullptr,
+                     const std::function<void(int, size_t)>& onGeneration = nullptr) const;
+
+    /**
+     * @brief 不展开而直接计算 iterations 代后的符号数量，超出 uint64_t 时饱和。
+     */
+    uint64_t ExpandedLength(const std::string& axiom, int iterations) const;
+
+private:
+    struct Alternative {
+        std::string successor;
+        float weight;           // 解析时为原始权重，解析完成后为归一化的累计权重
+    };
+
+    void AddProduction(const std::string& symbol, const std::string& production, float weight);
+
+    std::array<std::vector<Alternative>, 256> productions_;
+    std::array<uint8_t, 256> hasProduction_{};
+    std::array<uint32_t, 256> outputLength_{}; // 确定性文法中每个符号重写一次后的长度（无产生式为 1）
+    bool stochastic_ = false;
+    uint32_t seed_;
+    uint32_t variantCount_;
+};
@@ -0,0 +1,127 @@
+﻿#include "LSystemMesher.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // 每个并行块处理的线段数量，也是块内局部坐标系数组的长度
+    constexpr size_t kSegmentBlockSize = 1024;
+
+    /**
+     * @brief 某一分支深度的截面参数：半径与单位圆上各边方向的余弦、正弦。
+     */
+    struct RingProfile {
+        float radius;
+        std::vector<float> cosines;
+        std::vector<float> sines;
+    };
+}
+
+ModelData LSystemMesher::Build(const std::vector<LSystemTurtle::Segment>& segments, const Options& options, ThreadPool& threadPool) {
+    ModelData mesh;
+    mesh.filepath = "";
+    mesh.transform = glm::mat4(1.0f);
+    mesh.vertexShaderPath = "Shaders/default.vs";
+    mesh.fragmentShaderPath = "Shaders/default.fs";
+    mesh.parentUUID = "";
+    if (segments.empty()) return mesh;
+
+    // 每个深度的截面只计算一次
+    uint32_t maxDepth = 0;
+    for (const auto& segment : segments) maxDepth = std::max(maxDepth, segment.depth);
+    const int maxSides = std::max(options.maxSides, 3);
+    const int minSides = std::clamp(options.minSides, 3, maxSides);
+    std::vector<RingProfile> profiles(static_cast<size_t>(maxDepth) + 1);
+    float radius = options.radius;
+    for (auto& profile : profiles) {
+        profile.radius = std::max(radius, options.minRadius);
+        float ratio = options.radius > 0.0f ? profile.radius / options.radius : 1.0f;
+        int sides = std::clamp(static_cast<int>(std::ceil(maxSides * ratio)), minSides, maxSides);
+        for (int k = 0; k < sides; ++k) {
+            float angle = 6.28318530718f * k / sides;
+            profile.cosines.push_back(std::cos(angle));
+            profile.sines.push_back(std::sin(angle));
+        }
+        radius *= options.radiusFalloff;
+    }
+
+    // 前缀和：n 边截面的线段输出 2n 个顶点与 6n 个索引
+    std::vector<size_t> firstVertex(segments.size() + 1, 0);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        firstVertex[i + 1] = firstVertex[i] + 2 * profiles[segments[i].depth].cosines.size();
+    }
+    mesh.vertices.resize(firstVertex.back());
+    mesh.normals.resize(firstVertex.back());
+    mesh.indices.resize(firstVertex.back() * 3);
+
+    threadPool.ParallelFor(0, segments.size(), kSegmentBlockSize, [&](size_t blockBegin, size_t blockEnd) {
+        const size_t count = blockEnd - blockBegin;
+        // 局部坐标系：axis 为线段方向，side、other 与之正交，axis = side × other
+        float axisX[kSegmentBlockSize], axisY[kSegmentBlockSize], axisZ[kSegmentBlockSize];
+        float sideX[kSegmentBlockSize], sideY[kSegmentBlockSize], sideZ[kSegmentBlockSize];
+        float otherX[kSegmentBlockSize], otherY[kSegmentBlockSize], otherZ[kSegmentBlockSize];
+        for (size_t i = 0; i < count; ++i) {
+            const auto& segment = segments[blockBegin + i];
+            axisX[i] = segment.end.x - segment.start.x;
+            axisY[i] = segment.end.y - segment.start.y;
+            axisZ[i] = segment.end.z - segment.start.z;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            float lengthSquared = axisX[i] * axisX[i] + axisY[i] * axisY[i] + axisZ[i] * axisZ[i];
+            float inverse = lengthSquared > 0.0f ? 1.0f / std::sqrt(lengthSquared) : 0.0f;
+            float x = axisX[i] * inverse, y = axisY[i] * inverse, z = axisZ[i] * inverse;
+            y = lengthSquared > 0.0f ? y : 1.0f;
+            // side = axis × reference，axis 接近 Y 轴时参考方向取 X 轴
+            bool nearY = std::abs(y) >= 0.99f;
+            float sx = nearY ? 0.0f : -z;
+            float sy = nearY ? z : 0.0f;
+            float sz = nearY ? -y : x;
+            float sideInverse = 1.0f / std::sqrt(sx * sx + sy * sy + sz * sz);
+            sx *= sideInverse;
+            sy *= sideInverse;
+            sz *= sideInverse;
+            axisX[i] = x;
+            axisY[i] = y;
+            axisZ[i] = z;
+            sideX[i] = sx;
+            sideY[i] = sy;
+            sideZ[i] = sz;
+            otherX[i] = y * sz - z * sy;
+            otherY[i] = z * sx - x * sz;
+            otherZ[i] = x * sy - y * sx;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            const auto& segment = segments[blockBegin + i];
+            const RingProfile& profile = profiles[segment.depth];
+            const size_t sides = profile.cosines.size();
+            const size_t vertexBase = firstVertex[blockBegin + i];
+            glm::vec3* vertices = mesh.vertices.data() + vertexBase;
+            glm::vec3* normals = mesh.normals.data() + vertexBase;
+            for (size_t k = 0; k < sides; ++k) {
+                glm::vec3 direction(profile.cosines[k] * sideX[i] + profile.sines[k] * otherX[i],
+                                    profile.cosines[k] * sideY[i] + profile.sines[k] * otherY[i],
+                                    profile.cosines[k] * sideZ[i] + profile.sines[k] * otherZ[i]);
+                glm::vec3 offset = direction * profile.radius;
+                vertices[k] = segment.start + offset;
+                vertices[sides + k] = segment.end + offset;
+                normals[k] = direction;
+                normals[sides + k] = direction;
+            }
+            // 截面绕 axis 逆时针排列，(s_k, s_k+1, e_k+1) 的正面朝外
+            unsigned int base = static_cast<unsigned int>(vertexBase);
+            unsigned int n = static_cast<unsigned int>(sides);
+            unsigned int* out = mesh.indices.data() + vertexBase * 3;
+            for (unsigned int k = 0; k < n; ++k) {
+                unsigned int next = k + 1 == n ? 0 : k + 1;
+                out[0] = base + k;
+                out[1] = base + next;
+                out[2] = base + n + next;
+                out[3] = base + k;
+                out[4] = base + n + next;
+                out[5] = base + n + k;
+                out += 6;
+            }
+        }
+    });
+    return mesh;
+}
@@ -0,0 +1,29 @@
+﻿#pragma once
+#include <vector>
+#include <memory>
+#include "EventBus/EventTypes.h"
+#include "ThreadPool/ThreadPool.h"
+#include "LSystemTurtle.h"
+
+/**
+ * @brief 将海龟线段网格化为枝干。
+ *
+ * 每条线段输出为一段沿线段方向的广义圆柱（不封口），截面半径按分支深度逐级衰减：
+ * radius * radiusFalloff^depth，且不小于 minRadius。截面边数随半径相对主干的比例减少，
+ * 介于 minSides 与 maxSides 之间，细枝使用更少的面。
+ *
+ * 线段按块并行处理，块内先将各线段的局部坐标系批量计算到按分量连续存放的数组中，
+ * 便于编译器向量化；每条线段的输出位置由边数的前缀和确定，各块直接写入最终缓冲。
+ */
+class LSystemMesher {
+public:
+    struct Options {
+        float radius = 0.1f;        // 主干半径
+        float radiusFalloff = 0.7f; // 每深一级分支的半径比例
+        float minRadius = 0.001f;
+        int maxSides = 8;           // 主干截面边数
+        int minSides = 3;
+    };
+
+    static ModelData Build(const std::vector<LSystemTurtle::Segment>& segments, const Options& options, ThreadPool& threadPool);
+};
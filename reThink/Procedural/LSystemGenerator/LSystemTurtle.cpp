@@ -0,0 +1,91 @@
+﻿#include "LSystemTurtle.h"
+#include <cmath>
+
+LSystemTurtle::LSystemTurtle(float angleDegrees, float length) : length_(length) {
+    float radians = angleDegrees * 3.14159265358979f / 180.0f;
+    cos_ = std::cos(radians);
+    sin_ = std::sin(radians);
+    // 初始朝 +Y 生长，H × L = U 构成右手系
+    state_.position = glm::vec3(0.0f, 0.0f, 0.0f);
+    state_.heading = glm::vec3(0.0f, 1.0f, 0.0f);
+    state_.left = glm::vec3(-1.0f, 0.0f, 0.0f);
+    state_.up = glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+void LSystemTurtle::Rotate(glm::vec3& a, glm::vec3& b, float sign) {
+    glm::vec3 rotatedA = a * cos_ + b * (sin_ * sign);
+    glm::vec3 rotatedB = b * cos_ - a * (sin_ * sign);
+    a = rotatedA;
+    b = rotatedB;
+}
+
+void LSystemTurtle::Consume(uint8_t symbol) {
+    switch (symbol) {
+    case 'F':
+    case 'G': {
+        glm::vec3 start = state_.position;
+        state_.position = start + state_.heading * length_;
+        segments_.push_back({start, state_.position, static_cast<uint32_t>(stack_.size())});
+        break;
+    }
+    case 'f':
+    case 'g':
+        state_.position = state_.position + state_.heading * length_;
+        break;
+    case '+':
+        Rotate(state_.heading, state_.left, 1.0f);
+        break;
+    case '-':
+        Rotate(state_.heading, state_.left, -1.0f);
+        break;
+    case '&':
+        Rotate(state_.heading, state_.up, -1.0f);
+        break;
+    case '^':
+        Rotate(state_.heading, state_.up, 1.0f);
+        break;
+    case '\\':
+        Rotate(state_.left, state_.up, 1.0f);
+        break;
+    case '/':
+        Rotate(state_.left, state_.up, -1.0f);
+        break;
+    case '|':
+        state_.heading = -state_.heading;
+        state_.left = -state_.left;
+        break;
+    case '[':
+        stack_.push_back(state_);
+        break;
+    case ']':
+        // 多余的 ']' 忽略，避免不平衡的文法导致越界
+        if (!stack_.empty()) {
+            state_ = stack_.back();
+            stack_.pop_back();
+        } else {
+            underflow_ = true;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void LSystemTurtle::Advance(const State& relative) {
+    // 初始状态的 H、L、U 为 +Y、-X、+Z，相对量的分量按此映射到当前基
+    auto toWorld = [this](const glm::vec3& v) {
+        return state_.left * -v.x + state_.heading * v.y + state_.up * v.z;
+    };
+    State next;
+    next.position = state_.position + toWorld(relative.position);
+    next.heading = toWorld(relative.heading);
+    next.left = toWorld(relative.left);
+    next.up = toWorld(relative.up);
+    state_ = next;
+}
+
+void LSystemTurtle::Interpret(const uint8_t* symbols, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        Consume(symbols[i]);
+    }
+}
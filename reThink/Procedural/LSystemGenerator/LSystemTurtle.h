@@ -0,0 +1,71 @@
+﻿#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+/**
+ * @brief 三维海龟解释器，将 L 系统符号序列转换为线段。
+ *
+ * 海龟状态为位置与正交的前进方向 H、左方向 L、上方向 U，支持的命令：
+ * - F / G：前进一步并绘制线段；f / g：前进一步但不绘制；
+ * - + / -：绕 U 左转 / 右转；& / ^：绕 L 向下 / 向上俯仰；\ / /：绕 H 向左 / 向右滚转；| ：掉头；
+ * - [ / ]：压入 / 弹出海龟状态，开始 / 结束一个分支。
+ * 其余符号不影响海龟。旋转使用预先计算的正余弦直接更新三个方向向量。
+ *
+ * 符号可以一次性传入，也可以逐个传入，解释结果只取决于符号顺序。
+ * 已知一段符号对海龟状态的净影响时，可以用 Advance 直接跳过这段符号。
+ */
+class LSystemTurtle {
+public:
+    /**
+     * @brief 一条绘制的线段。
+     */
+    struct Segment {
+        glm::vec3 start;
+        glm::vec3 end;
+        uint32_t depth; // 所在分支的嵌套深度，主干为 0
+    };
+
+    /**
+     * @brief 海龟状态，H、L、U 为单位正交基且 H × L = U。
+     */
+    struct State {
+        glm::vec3 position;
+        glm::vec3 heading;
+        glm::vec3 left;
+        glm::vec3 up;
+    };
+
+    /**
+     * @param angleDegrees 每次转向的角度。
+     * @param length 每步前进的长度。
+     */
+    LSystemTurtle(float angleDegrees, float length);
+
+    void Consume(uint8_t symbol);
+    void Interpret(const uint8_t* symbols, size_t count);
+
+    /**
+     * @brief 以当前状态为原点应用一段符号的净影响，relative 为从初始状态解释这段符号后的状态。
+     */
+    void Advance(const State& relative);
+
+    const State& GetState() const { return state_; }
+    size_t GetStackDepth() const { return stack_.size(); }
+    // 是否遇到过没有对应 '[' 的 ']'
+    bool HasUnderflow() const { return underflow_; }
+    const std::vector<Segment>& GetSegments() const { return segments_; }
+    std::vector<Segment> TakeSegments() { return std::move(segments_); }
+
+private:
+    // 在由 a、b 张成的平面内旋转：a' = a cos + b sin，b' = b cos - a sin
+    void Rotate(glm::vec3& a, glm::vec3& b, float sign);
+
+    State state_;
+    std::vector<State> stack_;
+    float cos_;
+    float sin_;
+    float length_;
+    bool underflow_ = false;
+    std::vector<Segment> segments_;
+};
@@ -0,0 +1,395 @@
+﻿#include "ProceduralBatch.h"
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include "Utils/JSONSerializer.h"
+#include "Utils/ProcessMemory.h"
+#include "WFCGenerator/WFCGenerator.h"
+#include "LSystemGenerator/LSystemGenerator.h"
+#include "MaterialManager/MaterialManager.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    // 等待任务结束时分发事件队列的间隔
+    constexpr auto kDispatchInterval = std::chrono::milliseconds(2);
+    // OBJ 输出缓冲的大小，写满后整块写入文件
+    constexpr size_t kObjBufferSize = 4 * 1024 * 1024;
+
+    /**
+     * @brief 取出注册表中某个算法的参数默认值。
+     */
+    nlohmann::json DefaultParameters(const nlohmann::json& registry, const std::string& algorithmName) {
+        nlohmann::json params = nlohmann::json::object();
+        if (!registry.is_object() || !registry.contains("algorithms")) return params;
+        for (const auto& algo : registry["algorithms"]) {
+            if (algo.value("name", "") != algorithmName || !algo.contains("parameters")) continue;
+            for (const auto& [key, value] : algo["parameters"].items()) {
+                params[key] = value.is_object() && value.contains("default") ? value["default"] : value;
+            }
+        }
+        return params;
+    }
+
+    /**
+     * @brief 追加写入文本的缓冲，浮点数按最短往返格式输出。
+     */
+    class ObjWriter {
+    public:
+        explicit ObjWriter(const fs::path& path) : file_(path, std::ios::binary | std::ios::trunc) {
+            if (!file_) throw std::runtime_error("ProceduralBatch: 无法写入 " + path.string());
+            buffer_.reserve(kObjBufferSize + 256);
+        }
+
+        ~ObjWriter() { Flush(); }
+
+        void Text(const char* text) {
+            buffer_ += text;
+        }
+
+        void Line(const char* prefix, const glm::vec3& v) {
+            buffer_ += prefix;
+            Float(v.x);
+            Float(v.y);
+            Float(v.z);
+            End();
+        }
+
+        void Face(uint64_t a, uint64_t b, uint64_t c, bool withNormals) {
+            buffer_ += 'f';
+            for (uint64_t index : {a, b, c}) {
+                buffer_ += ' ';
+                Integer(index);
+                if (withNormals) {
+                    buffer_ += "//";
+                    Integer(index);
+                }
+            }
+            End();
+        }
+
+        void Flush() {
+            file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            buffer_.clear();
+        }
+
+    private:
+        void Float(float value) {
+            char text[32];
+            text[0] = ' ';
+            auto result = std::to_chars(text + 1, text + sizeof(text), value);
+            buffer_.append(text, result.ptr);
+        }
+
+        void Integer(uint64_t value) {
+            char text[24];
+            auto result = std::to_chars(text, text + sizeof(text), value);
+            buffer_.append(text, result.ptr);
+        }
+
+        void End() {
+            buffer_ += '\n';
+            if (buffer_.size() >= kObjBufferSize) Flush();
+        }
+
+        std::ofstream file_;
+        std::string buffer_;
+    };
+}
+
+ProceduralBatch::ProceduralBatch(std::shared_ptr<EventBus> eventBus, std::shared_ptr<ThreadPool> threadPool)
+    : eventBus_(eventBus), threadPool_(threadPool), chunkSubscription_(0), completedSubscription_(0), stoppedSubscription_(0) {
+    if (!eventBus_) throw std::invalid_argument("ProceduralBatch: EventBus cannot be null");
+    if (!threadPool_) throw std::invalid_argument("ProceduralBatch: ThreadPool cannot be null");
+    // 任务逐个执行，每个任务的统计只包含它自己
+    jobManager_ = std::make_unique<ProceduralJobManager>(eventBus_, threadPool_, 1);
+    SubscribeToEvents();
+}
+
+ProceduralBatch::~ProceduralBatch() {
+    jobManager_.reset();
+    eventBus_->Unsubscribe(typeid(MyRenderer::Events::ProceduralChunkReadyEvent), chunkSubscription_);
+    eventBus_->Unsubscribe(typeid(MyRenderer::Events::ProceduralGenerationCompletedEvent), completedSubscription_);
+    eventBus_->Unsubscribe(typeid(MyRenderer::Events::ProceduralGenerationStoppedEvent), stoppedSubscription_);
+}
+
+void ProceduralBatch::SubscribeToEvents() {
+    // 任务事件都在工作线程上入队，由 Run 所在的线程分发
+    chunkSubscription_ = eventBus_->Subscribe<MyRenderer::Events::ProceduralChunkReadyEvent>(
+        [this](const MyRenderer::Events::ProceduralChunkReadyEvent& event) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = outputs_.find(event.jobId);
+            if (it == outputs_.end()) return;
+            JobOutput& output = it->second;
+            auto existing = output.chunkIndex.find(event.chunkData.uuid);
+            if (existing != output.chunkIndex.end()) {
+                output.chunks[existing->second] = event.chunkData;
+            } else {
+                output.chunkIndex[event.chunkData.uuid] = output.chunks.size();
+                output.chunks.push_back(event.chunkData);
+            }
+        });
+
+    completedSubscription_ = eventBus_->Subscribe<MyRenderer::Events::ProceduralGenerationCompletedEvent>(
+        [this](const MyRenderer::Events::ProceduralGenerationCompletedEvent& event) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = outputs_.find(event.jobId);
+            if (it == outputs_.end()) return;
+            it->second.finished = true;
+            it->second.success = event.success;
+            it->second.errorMessage = event.errorMessage;
+        });
+
+    stoppedSubscription_ = eventBus_->Subscribe<MyRenderer::Events::ProceduralGenerationStoppedEvent>(
+        [this](const MyRenderer::Events::ProceduralGenerationStoppedEvent& event) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = outputs_.find(event.jobId);
+            if (it == outputs_.end()) return;
+            it->second.finished = true;
+            it->second.errorMessage = "Cancelled";
+        });
+}
+
+void ProceduralBatch::RegisterGenerator(std::shared_ptr<IProceduralGenerator> generator) {
+    if (!generator) throw std::invalid_argument("ProceduralBatch: Generator cannot be null");
+    workUnitNames_[generator->GetName()] = generator->GetWorkUnitName();
+    jobManager_->RegisterGenerator(generator);
+}
+
+std::vector<ProceduralBatch::JobReport> ProceduralBatch::Run(const nlohmann::json& batch, const nlohmann::json& registry, const Options& options) {
+    if (!batch.is_object() || !batch.contains("algorithms") || !batch["algorithms"].is_array()) {
+        throw std::invalid_argument("ProceduralBatch: Batch file must contain an \"algorithms\" array");
+    }
+    fs::create_directories(options.outputDirectory);
+
+    std::vector<JobReport> reports;
+    const auto& entries = batch["algorithms"];
+    for (size_t entryIndex = 0; entryIndex < entries.size(); ++entryIndex) {
+        const auto& entry = entries[entryIndex];
+        const std::string algorithmName = entry.value("name", "");
+        const int count = std::max(entry.value("count", 1), 1);
+        const std::string prefix = entry.value("output", algorithmName + "_" + std::to_string(entryIndex));
+
+        nlohmann::json params = DefaultParameters(registry, algorithmName);
+        if (entry.contains("parameters")) {
+            for (const auto& [key, value] : entry["parameters"].items()) {
+                params[key] = value.is_object() && value.contains("default") ? value["default"] : value;
+            }
+        }
+        const uint32_t baseSeed = params.value("seed", 0u);
+
+        for (int variant = 0; variant < count; ++variant) {
+            nlohmann::json variantParams = params;
+            std::string name = prefix;
+            if (count > 1) {
+                variantParams["seed"] = baseSeed + static_cast<uint32_t>(variant);
+                name += "_" + std::to_string(variant);
+            }
+            reports.push_back(RunJob(algorithmName, variantParams, name, options));
+        }
+    }
+
+    WriteReport(options.outputDirectory / "report.json", reports);
+    return reports;
+}
+
+ProceduralBatch::JobReport ProceduralBatch::RunJob(const std::string& algorithmName, const nlohmann::json& params,
+                                                   const std::string& name, const Options& options) {
+    JobReport report;
+    report.name = name;
+    report.algorithmName = algorithmName;
+    report.params = params;
+    auto nameIt = workUnitNames_.find(algorithmName);
+    report.workUnitName = nameIt != workUnitNames_.end() ? nameIt->second : "units";
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t jobId = 0;
+    try {
+        // 先登记输出再提交，任务可能在 Submit 返回前就已完成
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobId = jobManager_->Submit(algorithmName, params);
+        outputs_[jobId];
+    } catch (const std::exception& e) {
+        report.errorMessage = e.what();
+        std::cerr << "[Batch] " << name << " 提交失败: " << e.what() << std::endl;
+        return report;
+    }
+
+    for (;;) {
+        eventBus_->DispatchQueued();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (outputs_[jobId].finished) break;
+        }
+        std::this_thread::sleep_for(kDispatchInterval);
+    }
+
+    JobOutput output;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        output = std::move(outputs_[jobId]);
+        outputs_.erase(jobId);
+    }
+    report.success = output.success;
+    report.errorMessage = output.errorMessage;
+    report.chunkCount = output.chunks.size();
+    if (auto info = jobManager_->GetJob(jobId)) {
+        report.workUnits = info->workUnits;
+    }
+
+    if (report.success && options.writeMeshes) {
+        try {
+            fs::path path = options.outputDirectory / (name + ".obj");
+            auto [vertices, triangles] = WriteObj(path, output.chunks);
+            report.vertexCount = vertices;
+            report.triangleCount = triangles;
+            report.outputPath = path.string();
+        } catch (const std::exception& e) {
+            report.success = false;
+            report.errorMessage = e.what();
+        }
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report.peakMemoryBytes = ProcessMemory::GetPeakBytes();
+
+    if (report.success) {
+        double throughput = report.seconds > 0.0 ? report.workUnits / report.seconds : 0.0;
+        std::cout << "[Batch] " << name << " 完成，耗时 " << report.seconds << " s，" << report.workUnits << " " << report.workUnitName
+                  << "（" << throughput << " " << report.workUnitName << "/s），" << report.chunkCount << " 块，内存峰值 "
+                  << report.peakMemoryBytes / (1024 * 1024) << " MB" << std::endl;
+    } else {
+        std::cerr << "[Batch] " << name << " 失败: " << report.errorMessage << std::endl;
+    }
+    return report;
+}
+
+std::pair<uint64_t, uint64_t> ProceduralBatch::WriteObj(const fs::path& path, const std::vector<ModelData>& meshes) {
+    ObjWriter writer(path);
+    uint64_t vertexOffset = 0;
+    uint64_t triangleCount = 0;
+    for (const auto& mesh : meshes) {
+        const bool withNormals = mesh.normals.size() == mesh.vertices.size();
+        // OBJ 不支持实例化，每个实例展开为一份变换后的网格
+        std::vector<glm::mat4> transforms;
+        if (mesh.instanceTransforms.empty()) {
+            transforms.push_back(mesh.transform);
+        } else {
+            transforms.reserve(mesh.instanceTransforms.size());
+            for (const auto& instance : mesh.instanceTransforms) {
+                transforms.push_back(mesh.transform * instance);
+            }
+        }
+
+        for (size_t t = 0; t < transforms.size(); ++t) {
+            const glm::mat4& transform = transforms[t];
+            writer.Text("o ");
+            writer.Text(mesh.uuid.c_str());
+            if (transforms.size() > 1) {
+                writer.Text(("_" + std::to_string(t)).c_str());
+            }
+            writer.Text("\n");
+            for (const auto& vertex : mesh.vertices) {
+                writer.Line("v", glm::vec3(transform * glm::vec4(vertex, 1.0f)));
+            }
+            if (withNormals) {
+                for (const auto& normal : mesh.normals) {
+                    writer.Line("vn", glm::normalize(glm::vec3(transform * glm::vec4(normal, 0.0f))));
+                }
+            }
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+                writer.Face(vertexOffset + mesh.indices[i] + 1, vertexOffset + mesh.indices[i + 1] + 1,
+                            vertexOffset + mesh.indices[i + 2] + 1, withNormals);
+            }
+            vertexOffset += mesh.vertices.size();
+            triangleCount += mesh.indices.size() / 3;
+        }
+    }
+    return {vertexOffset, triangleCount};
+}
+
+void ProceduralBatch::WriteReport(const fs::path& path, const std::vector<JobReport>& reports) {
+    nlohmann::json jobs = nlohmann::json::array();
+    for (const auto& report : reports) {
+        jobs.push_back({
+            {"name", report.name},
+            {"algorithm", report.algorithmName},
+            {"parameters", report.params},
+            {"success", report.success},
+            {"error", report.errorMessage},
+            {"seconds", report.seconds},
+            {"workUnits", report.workUnits},
+            {"workUnitName", report.workUnitName},
+            {"throughput", report.seconds > 0.0 ? report.workUnits / report.seconds : 0.0},
+            {"chunks", report.chunkCount},
+            {"vertices", report.vertexCount},
+            {"triangles", report.triangleCount},
+            {"peakMemoryBytes", report.peakMemoryBytes},
+            {"output", report.outputPath}
+        });
+    }
+    std::ofstream file(path);
+    file << nlohmann::json{{"jobs", jobs}}.dump(4);
+}
+
+int ProceduralBatch::RunCommandLine(int argc, char** argv) {
+    std::string batchFile;
+    Options options;
+    size_t threadCount = std::thread::hardware_concurrency();
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--batch" && i + 1 < argc) {
+            batchFile = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outputDirectory = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threadCount = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--no-mesh") {
+            options.writeMeshes = false;
+        } else {
+            batchFile.clear();
+            break;
+        }
+    }
+    if (batchFile.empty()) {
+        std::cerr << "用法: reThink --batch <任务文件> [--out <目录>] [--threads <线程数>] [--no-mesh]" << std::endl;
+        return 2;
+    }
+
+    try {
+        nlohmann::json batch = JSONSerializer::DeserializeFromFile<nlohmann::json>(batchFile);
+        nlohmann::json registry;
+        try {
+            registry = JSONSerializer::DeserializeFromFile<nlohmann::json>("Core/Config/ProceduralRegister.json");
+        } catch (const std::exception& e) {
+            std::cerr << "[Batch] 未读取到参数默认值: " << e.what() << std::endl;
+        }
+
+        auto eventBus = std::make_shared<EventBus>();
+        auto threadPool = std::make_shared<ThreadPool>(std::max<size_t>(threadCount, 1), ThreadPool::SchedulingMode::WorkStealing);
+        // 没有 OpenGL 上下文，材质只记录纹理路径而不创建纹理
+        auto materialManager = std::make_shared<MaterialManager>(eventBus);
+        auto modelLoader = std::make_shared<ModelLoader>(eventBus, threadPool, materialManager);
+
+        std::vector<JobReport> reports;
+        auto start = std::chrono::steady_clock::now();
+        {
+            ProceduralBatch runner(eventBus, threadPool);
+            runner.RegisterGenerator(std::make_shared<WFCGenerator>(modelLoader, threadPool));
+            runner.RegisterGenerator(std::make_shared<LSystemGenerator>(threadPool));
+            reports = runner.Run(batch, registry, options);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t failed = std::count_if(reports.begin(), reports.end(), [](const JobReport& report) { return !report.success; });
+        std::cout << "[Batch] 共 " << reports.size() << " 个任务，失败 " << failed << " 个，总耗时 " << seconds
+                  << " s，内存峰值 " << ProcessMemory::GetPeakBytes() / (1024 * 1024) << " MB" << std::endl;
+        return failed == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "[Batch] " << e.what() << std::endl;
+        return 1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+﻿#pragma once
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include "ProceduralJobManager/ProceduralJobManager.h"
+
+/**
+ * @brief 无界面的批量程序化生成，不创建窗口和 OpenGL 上下文，可在没有 GPU 的机器上运行。
+ *
+ * 任务文件与 ProceduralRegister.json 格式相同：
+ * { "algorithms": [ { "name": "LSystem", "parameters": { ... }, "count": 100 } ] }
+ * 参数可以写成 { "type": ..., "default": ... } 或直接写值，未给出的参数取注册表中的默认值。
+ * count 为变体数量（默认 1），第 i 个变体的 seed 为 seed + i。
+ *
+ * 任务逐个通过 ProceduralJobManager 执行，每个任务独占整个线程池，输出的网格块写为一个 OBJ 文件。
+ * 每个任务统计耗时、吞吐量（生成器报告的工作量每秒，如 cells/s、symbols/s）与进程内存峰值，
+ * 汇总写入输出目录下的 report.json。内存峰值是进程启动以来的最大值，只在峰值出现的任务上
+ * 反映该任务的占用；需要精确的单任务峰值时，每个进程只运行一个任务。
+ */
+class ProceduralBatch {
+public:
+    struct Options {
+        std::filesystem::path outputDirectory = "BatchOutput";
+        bool writeMeshes = true;  // 为 false 时只生成不写网格文件，用于测量生成本身；report.json 总会写出
+    };
+
+    /**
+     * @brief 单个任务的结果与统计。
+     */
+    struct JobReport {
+        std::string name;            // 输出文件名（不含扩展名）
+        std::string algorithmName;
+        nlohmann::json params;
+        bool success = false;
+        std::string errorMessage;
+        double seconds = 0.0;        // 从提交到最后一块网格写完的时间
+        uint64_t workUnits = 0;
+        std::string workUnitName;
+        size_t chunkCount = 0;
+        uint64_t vertexCount = 0;    // 写出的顶点数，实例化网格按实例展开
+        uint64_t triangleCount = 0;
+        uint64_t peakMemoryBytes = 0;
+        std::string outputPath;
+    };
+
+    ProceduralBatch(std::shared_ptr<EventBus> eventBus, std::shared_ptr<ThreadPool> threadPool);
+    ~ProceduralBatch();
+
+    ProceduralBatch(const ProceduralBatch&) = delete;
+    ProceduralBatch& operator=(const ProceduralBatch&) = delete;
+
+    void RegisterGenerator(std::shared_ptr<IProceduralGenerator> generator);
+
+    /**
+     * @brief 依次执行任务文件中的全部任务，必须在分发 EventBus 队列的线程上调用。
+     * @param batch 任务文件内容。
+     * @param registry ProceduralRegister.json 的内容，提供参数默认值，可为空。
+     * @throws std::invalid_argument 任务文件格式错误时抛出；单个任务失败只记录在报告中。
+     */
+    std::vector<JobReport> Run(const nlohmann::json& batch, const nlohmann::json& registry, const Options& options);
+
+    /**
+     * @brief 命令行入口：reThink --batch <任务文件> [--out <目录>] [--threads <线程数>] [--no-mesh]
+     * @return 进程退出码，全部任务成功时为 0。
+     */
+    static int RunCommandLine(int argc, char** argv);
+
+private:
+    /**
+     * @brief 一个任务收到的输出，由事件回调填充。
+     */
+    struct JobOutput {
+        bool finished = false;
+        bool success = false;
+        std::string errorMessage;
+        std::vector<ModelData> chunks;
+        std::map<std::string, size_t> chunkIndex; // UUID 到 chunks 下标，同一块重新输出时替换
+    };
+
+    void SubscribeToEvents();
+    JobReport RunJob(const std::string& algorithmName, const nlohmann::json& params, const std::string& name, const Options& options);
+    // 写出 OBJ，返回写出的顶点数与三角形数
+    static std::pair<uint64_t, uint64_t> WriteObj(const std::filesystem::path& path, const std::vector<ModelData>& meshes);
+    static void WriteReport(const std::filesystem::path& path, const std::vector<JobReport>& reports);
+
+    std::shared_ptr<EventBus> eventBus_;
+    std::shared_ptr<ThreadPool> threadPool_;
+    std::unique_ptr<ProceduralJobManager> jobManager_;
+    std::map<std::string, std::string> workUnitNames_;
+    EventBus::SubscriberId chunkSubscription_;
+    EventBus::SubscriberId completedSubscription_;
+    EventBus::SubscriberId stoppedSubscription_;
+
+    std::mutex mutex_;
+    std::map<uint64_t, JobOutput> outputs_;
+};
\ No newline at end of file
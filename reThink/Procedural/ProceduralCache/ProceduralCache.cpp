@@ -0,0 +1,368 @@
+﻿#include "ProceduralCache.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr char kMagic[4] = {'R', 'T', 'P', 'C'};
+    // 条目文件格式版本，布局改变时递增，旧文件读取时视为损坏并删除
+    constexpr uint32_t kFormatVersion = 1;
+    constexpr const char* kEntryExtension = ".rpc";
+
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+    static_assert(sizeof(glm::mat4) == 16 * sizeof(float), "glm::mat4 must be tightly packed");
+
+    /**
+     * @brief 追加写入的字节缓冲。
+     */
+    class Writer {
+    public:
+        template<typename T>
+        void Pod(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+        }
+
+        void String(const std::string& value) {
+            Pod<uint64_t>(value.size());
+            buffer_.insert(buffer_.end(), value.begin(), value.end());
+        }
+
+        template<typename T>
+        void Array(const std::vector<T>& values) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Pod<uint64_t>(values.size());
+            const char* bytes = reinterpret_cast<const char*>(values.data());
+            buffer_.insert(buffer_.end(), bytes, bytes + values.size() * sizeof(T));
+        }
+
+        void Model(const ModelData& model) {
+            String(model.uuid);
+            String(model.filepath);
+            String(model.vertexShaderPath);
+            String(model.fragmentShaderPath);
+            String(model.parentUUID);
+            Pod<uint64_t>(model.materialUUIDs.size());
+            for (const auto& uuid : model.materialUUIDs) String(uuid);
+            Pod(model.transform);
+            Array(model.vertices);
+            Array(model.normals);
+            Array(model.indices);
+            Array(model.instanceTransforms);
+        }
+
+        const std::vector<char>& Data() const { return buffer_; }
+
+    private:
+        std::vector<char> buffer_;
+    };
+
+    /**
+     * @brief 带越界检查的读取器，任何读取失败后 Ok() 为 false。
+     */
+    class Reader {
+    public:
+        Reader(const char* data, size_t size) : data_(data), size_(size), position_(0), ok_(true) {}
+
+        template<typename T>
+        T Pod() {
+            T value{};
+            if (Take(sizeof(T))) std::memcpy(&value, data_ + position_ - sizeof(T), sizeof(T));
+            return value;
+        }
+
+        std::string String() {
+            uint64_t length = Pod<uint64_t>();
+            if (!Take(length)) return {};
+            return std::string(data_ + position_ - length, length);
+        }
+
+        template<typename T>
+        std::vector<T> Array() {
+            uint64_t count = Pod<uint64_t>();
+            std::vector<T> values;
+            if (!ok_ || count > (size_ - position_) / sizeof(T) || !Take(count * sizeof(T))) {
+                ok_ = false;
+                return values;
+            }
+            values.resize(count);
+            if (count > 0) std::memcpy(values.data(), data_ + position_ - count * sizeof(T), count * sizeof(T));
+            return values;
+        }
+
+        ModelData Model() {
+            ModelData model;
+            model.uuid = String();
+            model.filepath = String();
+            model.vertexShaderPath = String();
+            model.fragmentShaderPath = String();
+            model.parentUUID = String();
+            uint64_t materialCount = Pod<uint64_t>();
+            for (uint64_t i = 0; ok_ && i < materialCount; ++i) {
+                model.materialUUIDs.push_back(String());
+            }
+            model.transform = Pod<glm::mat4>();
+            model.vertices = Array<glm::vec3>();
+            model.normals = Array<glm::vec3>();
+            model.indices = Array<unsigned int>();
+            model.instanceTransforms = Array<glm::mat4>();
+            return model;
+        }
+
+        bool Ok() const { return ok_; }
+        bool AtEnd() const { return position_ == size_; }
+
+    private:
+        bool Take(uint64_t bytes) {
+            if (!ok_ || bytes > size_ - position_) {
+                ok_ = false;
+                return false;
+            }
+            position_ += static_cast<size_t>(bytes);
+            return true;
+        }
+
+        const char* data_;
+        size_t size_;
+        size_t position_;
+        bool ok_;
+    };
+
+    uint64_t Fnv1a(const std::string& text) {
+        uint64_t hash = 1469598103934665603ull;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+ProceduralCache::ProceduralCache(const fs::path& directory, uint64_t maxBytes)
+    : directory_(directory), available_(false), maxBytes_(maxBytes) {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    available_ = fs::is_directory(directory_, ec);
+    if (!available_) {
+        std::cerr << "[ProceduralCache] 无法创建缓存目录 " << directory_.string() << "，缓存已禁用" << std::endl;
+        return;
+    }
+    LoadIndex();
+    std::lock_guard<std::mutex> lock(mutex_);
+    EvictLocked();
+}
+
+std::string ProceduralCache::MakeKey(const std::string& algorithmName, uint32_t generatorVersion, const nlohmann::json& params,
+                                     const std::vector<std::string>& inputFiles) {
+    // nlohmann::json 的对象按键排序存储，dump() 的结果与参数的插入顺序无关
+    std::string key = algorithmName + '\n' + std::to_string(generatorVersion) + '\n' + params.dump() + '\n';
+    for (const auto& file : inputFiles) {
+        std::error_code ec;
+        uint64_t size = fs::file_size(file, ec);
+        if (ec) size = 0;
+        auto modified = fs::last_write_time(file, ec);
+        long long ticks = ec ? 0 : static_cast<long long>(modified.time_since_epoch().count());
+        key += file + '|' + std::to_string(size) + '|' + std::to_string(ticks) + '\n';
+    }
+    return key;
+}
+
+std::string ProceduralCache::FileNameForKey(const std::string& key) {
+    static const char* digits = "0123456789abcdef";
+    uint64_t hash = Fnv1a(key);
+    std::string name(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        name[i] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+    return name + kEntryExtension;
+}
+
+void ProceduralCache::LoadIndex() {
+    std::vector<std::pair<fs::file_time_type, std::pair<std::string, uint64_t>>> files;
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(directory_, ec)) {
+        if (!item.is_regular_file(ec) || item.path().extension() != kEntryExtension) continue;
+        uint64_t size = item.file_size(ec);
+        if (ec) continue;
+        auto modified = item.last_write_time(ec);
+        if (ec) continue;
+        files.push_back({modified, {item.path().filename().string(), size}});
+    }
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [modified, file] : files) {
+        lru_.push_back(file.first);
+        index_[file.first] = IndexEntry{file.second, std::prev(lru_.end())};
+        stats_.totalBytes += file.second;
+    }
+    stats_.entryCount = index_.size();
+}
+
+std::optional<ProceduralCache::Entry> ProceduralCache::Load(const std::string& key) {
+    const std::string fileName = FileNameForKey(key);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!available_ || index_.find(fileName) == index_.end()) {
+            stats_.misses++;
+            return std::nullopt;
+        }
+    }
+
+    // 读文件不持有锁，其他任务可以同时查询；文件在此期间被淘汰时按未命中处理
+    const fs::path path = directory_ / fileName;
+    std::vector<char> data;
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (file) {
+            std::streamoff size = file.tellg();
+            if (size > 0) {
+                data.resize(static_cast<size_t>(size));
+                file.seekg(0);
+                if (!file.read(data.data(), size)) data.clear();
+            }
+        }
+    }
+
+    Entry entry;
+    bool valid = false;
+    if (data.size() >= sizeof(kMagic) && std::memcmp(data.data(), kMagic, sizeof(kMagic)) == 0) {
+        Reader reader(data.data() + sizeof(kMagic), data.size() - sizeof(kMagic));
+        if (reader.Pod<uint32_t>() == kFormatVersion && reader.String() == key) {
+            entry.result = reader.Model();
+            uint64_t chunkCount = reader.Pod<uint64_t>();
+            for (uint64_t i = 0; reader.Ok() && i < chunkCount; ++i) {
+                ProceduralMeshChunk chunk;
+                chunk.index = static_cast<size_t>(reader.Pod<uint64_t>());
+                chunk.count = static_cast<size_t>(reader.Pod<uint64_t>());
+                chunk.mesh = reader.Model();
+                entry.chunks.push_back(std::move(chunk));
+            }
+            valid = reader.Ok() && reader.AtEnd();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(fileName);
+    if (!valid) {
+        // 损坏、旧格式或哈希冲突的条目都不再保留
+        if (it != index_.end()) {
+            RemoveLocked(fileName);
+        }
+        stats_.misses++;
+        return std::nullopt;
+    }
+    if (it != index_.end()) {
+        lru_.splice(lru_.end(), lru_, it->second.position);
+    }
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    stats_.hits++;
+    return entry;
+}
+
+bool ProceduralCache::Store(const std::string& key, const Entry& entry) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!available_) return false;
+    }
+
+    Writer writer;
+    for (char c : kMagic) writer.Pod(c);
+    writer.Pod(kFormatVersion);
+    writer.String(key);
+    writer.Model(entry.result);
+    writer.Pod<uint64_t>(entry.chunks.size());
+    for (const auto& chunk : entry.chunks) {
+        writer.Pod<uint64_t>(chunk.index);
+        writer.Pod<uint64_t>(chunk.count);
+        writer.Model(chunk.mesh);
+    }
+    const uint64_t size = writer.Data().size();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (size > maxBytes_) return false;
+    }
+
+    // 先写临时文件再重命名，读取方不会看到写了一半的条目
+    const std::string fileName = FileNameForKey(key);
+    const fs::path path = directory_ / fileName;
+    fs::path temporary = path;
+    temporary += ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(writer.Data().data(), static_cast<std::streamsize>(size))) {
+            std::cerr << "[ProceduralCache] 写入失败: " << temporary.string() << std::endl;
+            file.close();
+            std::error_code ec;
+            fs::remove(temporary, ec);
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    fs::rename(temporary, path, ec);
+    if (ec) {
+        fs::remove(temporary, ec);
+        return false;
+    }
+    auto it = index_.find(fileName);
+    if (it != index_.end()) {
+        stats_.totalBytes -= it->second.size;
+        it->second.size = size;
+        lru_.splice(lru_.end(), lru_, it->second.position);
+    } else {
+        lru_.push_back(fileName);
+        index_[fileName] = IndexEntry{size, std::prev(lru_.end())};
+    }
+    stats_.totalBytes += size;
+    stats_.stores++;
+    stats_.entryCount = index_.size();
+    EvictLocked();
+    return true;
+}
+
+void ProceduralCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!lru_.empty()) {
+        RemoveLocked(lru_.front());
+    }
+}
+
+void ProceduralCache::SetMaxBytes(uint64_t maxBytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxBytes_ = maxBytes;
+    EvictLocked();
+}
+
+ProceduralCache::Stats ProceduralCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ProceduralCache::EvictLocked() {
+    while (stats_.totalBytes > maxBytes_ && !lru_.empty()) {
+        RemoveLocked(lru_.front());
+        stats_.evictions++;
+    }
+}
+
+void ProceduralCache::RemoveLocked(const std::string& fileName) {
+    auto it = index_.find(fileName);
+    if (it == index_.end()) return;
+    std::error_code ec;
+    fs::remove(directory_ / fileName, ec);
+    stats_.totalBytes -= it->second.size;
+    lru_.erase(it->second.position);
+    index_.erase(it);
+    stats_.entryCount = index_.size();
+}
\ No newline at end of file
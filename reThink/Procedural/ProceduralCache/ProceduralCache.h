@@ -0,0 +1,102 @@
+﻿#pragma once
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <filesystem>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+#include "IProceduralGenerator/IProceduralGenerator.h"
+
+/**
+ * @brief 程序化生成结果的磁盘缓存。
+ *
+ * 缓存键由算法名称、生成器版本、规范化的参数 JSON（对象键有序，包含 seed）以及输入文件的
+ * 大小与修改时间组成，文件名为缓存键的 64 位哈希。文件内保存完整的缓存键，读取时逐字节比较，
+ * 哈希冲突只会被当作未命中。
+ *
+ * 每个条目保存生成结果的根节点与按顺序输出的全部网格块，几何数据以紧凑的二进制数组写入，
+ * 读取时整块拷贝，不做逐顶点解析。格式使用本机字节序，只在同一台机器上复用。
+ *
+ * 条目总大小超过上限时按最近最少使用的顺序淘汰，命中的条目会更新文件修改时间，
+ * 重启后按修改时间恢复使用顺序。所有成员函数都可以在任意线程并发调用。
+ */
+class ProceduralCache {
+public:
+    /**
+     * @brief 一次生成的完整输出。
+     */
+    struct Entry {
+        ModelData result;
+        std::vector<ProceduralMeshChunk> chunks;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t evictions = 0;
+        uint64_t totalBytes = 0;   // 当前所有条目文件的总大小
+        size_t entryCount = 0;
+    };
+
+    /**
+     * @param directory 缓存目录，不存在时创建；无法创建时缓存不可用，读写都直接失败。
+     * @param maxBytes 条目总大小上限（字节）。
+     */
+    ProceduralCache(const std::filesystem::path& directory, uint64_t maxBytes);
+
+    ProceduralCache(const ProceduralCache&) = delete;
+    ProceduralCache& operator=(const ProceduralCache&) = delete;
+
+    /**
+     * @brief 构造缓存键。
+     * @param inputFiles 结果依赖的外部文件，不存在的文件也会记入键中。
+     */
+    static std::string MakeKey(const std::string& algorithmName, uint32_t generatorVersion, const nlohmann::json& params,
+                               const std::vector<std::string>& inputFiles);
+
+    /**
+     * @brief 读取条目，未命中或文件损坏时返回空。
+     */
+    std::optional<Entry> Load(const std::string& key);
+
+    /**
+     * @brief 写入条目并按需淘汰旧条目，单个条目超过上限时不写入。
+     * @return 是否写入成功。
+     */
+    bool Store(const std::string& key, const Entry& entry);
+
+    /**
+     * @brief 删除全部条目，统计计数保持不变。
+     */
+    void Clear();
+
+    void SetMaxBytes(uint64_t maxBytes);
+    Stats GetStats() const;
+
+private:
+    struct IndexEntry {
+        uint64_t size;
+        std::list<std::string>::iterator position; // 在 lru_ 中的位置
+    };
+
+    static std::string FileNameForKey(const std::string& key);
+    // 扫描缓存目录，按修改时间从旧到新建立使用顺序
+    void LoadIndex();
+    // 在持有 mutex_ 时调用，淘汰最久未使用的条目直到总大小不超过上限
+    void EvictLocked();
+    // 在持有 mutex_ 时调用
+    void RemoveLocked(const std::string& fileName);
+
+    std::filesystem::path directory_;
+    bool available_;
+
+    mutable std::mutex mutex_;
+    uint64_t maxBytes_;
+    std::list<std::string> lru_;  // 文件名，最近使用的在末尾
+    std::unordered_map<std::string, IndexEntry> index_;
+    Stats stats_;
+};
\ No newline at end of file
@@ -0,0 +1,319 @@
+﻿#include "ProceduralJobManager.h"
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    // 保留状态以供查询的已结束任务数量
+    constexpr size_t kMaxFinishedJobs = 64;
+
+    /**
+     * @brief 为缓存的输出换上新的根节点 UUID，重复打开同一结果时各块的 UUID 不与场景中已有的模型冲突。
+     */
+    void RebaseUUIDs(ProceduralCache::Entry& entry) {
+        const std::string oldRoot = entry.result.uuid;
+        const size_t separator = oldRoot.rfind('_');
+        const std::string newRoot = (separator == std::string::npos ? oldRoot : oldRoot.substr(0, separator)) + "_" +
+                                    std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+        auto rebase = [&](std::string& uuid) {
+            if (!oldRoot.empty() && uuid.compare(0, oldRoot.size(), oldRoot) == 0) {
+                uuid = newRoot + uuid.substr(oldRoot.size());
+            }
+        };
+        rebase(entry.result.uuid);
+        for (auto& chunk : entry.chunks) {
+            rebase(chunk.mesh.uuid);
+            rebase(chunk.mesh.parentUUID);
+        }
+    }
+}
+
+ProceduralJobManager::ProceduralJobManager(std::shared_ptr<EventBus> eventBus, std::shared_ptr<ThreadPool> threadPool, size_t maxConcurrentJobs)
+    : eventBus_(eventBus), threadPool_(threadPool), maxConcurrentJobs_(1), requestSubscription_(0), cancelSubscription_(0),
+      runningCount_(0), nextJobId_(1), shuttingDown_(false) {
+    if (!eventBus_) throw std::invalid_argument("ProceduralJobManager: EventBus cannot be null");
+    if (!threadPool_) throw std::invalid_argument("ProceduralJobManager: ThreadPool cannot be null");
+    SetMaxConcurrentJobs(maxConcurrentJobs);
+    SubscribeToEvents();
+}
+
+ProceduralJobManager::~ProceduralJobManager() {
+    eventBus_->Unsubscribe(typeid(MyRenderer::Events::RequestModelCreatedEvent), requestSubscription_);
+    eventBus_->Unsubscribe(typeid(MyRenderer::Events::RequestGenerationCancelEvent), cancelSubscription_);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    shuttingDown_ = true;
+    queue_.clear();
+    for (auto& [id, job] : jobs_) {
+        if (job->context) job->context->Cancel();
+    }
+    idleCondition_.wait(lock, [this] { return runningCount_ == 0; });
+}
+
+void ProceduralJobManager::SubscribeToEvents() {
+    requestSubscription_ = eventBus_->Subscribe<MyRenderer::Events::RequestModelCreatedEvent>(
+        [this](const MyRenderer::Events::RequestModelCreatedEvent& event) {
+            try {
+                Submit(event.algorithmName, event.params);
+            } catch (const std::exception& e) {
+                eventBus_->Enqueue(MyRenderer::Events::ProceduralGenerationCompletedEvent{false, e.what(), ModelData{}});
+            }
+        });
+
+    cancelSubscription_ = eventBus_->Subscribe<MyRenderer::Events::RequestGenerationCancelEvent>(
+        [this](const MyRenderer::Events::RequestGenerationCancelEvent& event) {
+            if (event.jobId == 0) {
+                CancelAll();
+            } else {
+                Cancel(event.jobId);
+            }
+        });
+}
+
+void ProceduralJobManager::RegisterGenerator(std::shared_ptr<IProceduralGenerator> generator) {
+    if (!generator) throw std::invalid_argument("ProceduralJobManager: Generator cannot be null");
+    std::lock_guard<std::mutex> lock(mutex_);
+    generators_[generator->GetName()] = generator;
+}
+
+uint64_t ProceduralJobManager::Submit(const std::string& algorithmName, const nlohmann::json& params) {
+    std::vector<std::shared_ptr<Job>> startable;
+    uint64_t jobId;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto generator = generators_.find(algorithmName);
+        if (generator == generators_.end()) {
+            throw std::invalid_argument("ProceduralJobManager: Unknown algorithm: " + algorithmName);
+        }
+        if (shuttingDown_) {
+            throw std::runtime_error("ProceduralJobManager: Shutting down");
+        }
+
+        auto job = std::make_shared<Job>();
+        jobId = nextJobId_++;
+        job->info.id = jobId;
+        job->info.algorithmName = algorithmName;
+        job->params = params;
+        job->generator = generator->second;
+        job->context = std::make_shared<ProceduralJobContext>(jobId, eventBus_);
+        job->cache = cache_;
+        jobs_[jobId] = job;
+        queue_.push_back(job);
+        startable = TakeStartableJobs();
+    }
+    Launch(startable);
+    return jobId;
+}
+
+bool ProceduralJobManager::Cancel(uint64_t jobId) {
+    bool wasQueued = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.find(jobId);
+        if (it == jobs_.end()) return false;
+        auto& job = it->second;
+        if (job->info.state == JobState::Running) {
+            job->context->Cancel();
+            return true;
+        }
+        if (job->info.state != JobState::Queued) return false;
+
+        // 尚未开始的任务直接结束，不占用执行槽
+        queue_.erase(std::find(queue_.begin(), queue_.end(), job));
+        job->info.state = JobState::Cancelled;
+        finishedJobs_.push_back(jobId);
+        TrimFinishedJobs();
+        wasQueued = true;
+    }
+    if (wasQueued) {
+        eventBus_->Enqueue(MyRenderer::Events::ProceduralGenerationStoppedEvent{jobId});
+    }
+    return true;
+}
+
+void ProceduralJobManager::CancelAll() {
+    std::vector<uint64_t> stopped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& job : queue_) {
+            job->info.state = JobState::Cancelled;
+            finishedJobs_.push_back(job->info.id);
+            stopped.push_back(job->info.id);
+        }
+        queue_.clear();
+        TrimFinishedJobs();
+        for (const auto& [id, job] : jobs_) {
+            if (job->info.state == JobState::Running) job->context->Cancel();
+        }
+    }
+    for (uint64_t jobId : stopped) {
+        eventBus_->Enqueue(MyRenderer::Events::ProceduralGenerationStoppedEvent{jobId});
+    }
+}
+
+std::optional<ProceduralJobManager::JobInfo> ProceduralJobManager::GetJob(uint64_t jobId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(jobId);
+    if (it == jobs_.end()) return std::nullopt;
+    JobInfo info = it->second->info;
+    if (info.state == JobState::Running) {
+        info.progress = it->second->context->GetProgress();
+    }
+    return info;
+}
+
+std::vector<ProceduralJobManager::JobInfo> ProceduralJobManager::GetJobs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<JobInfo> result;
+    result.reserve(jobs_.size());
+    for (const auto& [id, job] : jobs_) {
+        result.push_back(job->info);
+        if (job->info.state == JobState::Running) {
+            result.back().progress = job->context->GetProgress();
+        }
+    }
+    return result;
+}
+
+void ProceduralJobManager::SetMaxConcurrentJobs(size_t maxConcurrentJobs) {
+    std::vector<std::shared_ptr<Job>> startable;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        maxConcurrentJobs_ = std::max<size_t>(maxConcurrentJobs, 1);
+        startable = TakeStartableJobs();
+    }
+    Launch(startable);
+}
+
+size_t ProceduralJobManager::GetMaxConcurrentJobs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxConcurrentJobs_;
+}
+
+void ProceduralJobManager::SetCache(std::shared_ptr<ProceduralCache> cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_ = cache;
+}
+
+std::shared_ptr<ProceduralCache> ProceduralJobManager::GetCache() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cache_;
+}
+
+std::vector<std::shared_ptr<ProceduralJobManager::Job>> ProceduralJobManager::TakeStartableJobs() {
+    std::vector<std::shared_ptr<Job>> startable;
+    while (!shuttingDown_ && runningCount_ < maxConcurrentJobs_ && !queue_.empty()) {
+        auto job = queue_.front();
+        queue_.pop_front();
+        job->info.state = JobState::Running;
+        runningCount_++;
+        startable.push_back(job);
+    }
+    return startable;
+}
+
+void ProceduralJobManager::Launch(const std::vector<std::shared_ptr<Job>>& jobs) {
+    for (const auto& job : jobs) {
+        threadPool_->Async([this, job]() { RunJob(job); });
+    }
+}
+
+void ProceduralJobManager::RunJob(const std::shared_ptr<Job>& job) {
+    ProceduralJobContext& context = *job->context;
+    eventBus_->Enqueue(MyRenderer::Events::ProceduralGenerationStartedEvent{job->info.id});
+
+    job->start = std::chrono::steady_clock::now();
+    try {
+        std::optional<ProceduralCache::Entry> cached;
+        if (job->cache) {
+            job->cacheKey = ProceduralCache::MakeKey(job->info.algorithmName, job->generator->GetVersion(), job->params,
+                                                     job->generator->GetInputFiles(job->params));
+            cached = job->cache->Load(job->cacheKey);
+        }
+        if (cached) {
+            RebaseUUIDs(*cached);
+            for (size_t i = 0; i < cached->chunks.size() && !context.IsCancelled(); ++i) {
+                auto& chunk = cached->chunks[i];
+                context.EmitMesh(std::move(chunk.mesh), chunk.index, chunk.count);
+            }
+            FinishJob(job, std::move(cached->result), false, "", true);
+            return;
+        }
+
+        // 准备阶段发起的任务（如加载瓦片模型）完成后再执行生成器，工作线程不会阻塞等待
+        context.SetRecording(job->cache != nullptr);
+        std::vector<ThreadPool::TaskHandle> prepared = job->generator->Prepare(job->params, context);
+        threadPool_->Async([this, job]() { RunGenerator(job); }, prepared);
+    } catch (const std::exception& e) {
+        FinishJob(job, ModelData{}, true, e.what(), false);
+    } catch (...) {
+        FinishJob(job, ModelData{}, true, "Unknown error", false);
+    }
+}
+
+void ProceduralJobManager::RunGenerator(const std::shared_ptr<Job>& job) {
+    try {
+        ModelData result = job->generator->Generate(job->params, *job->context);
+        FinishJob(job, std::move(result), false, "", false);
+    } catch (const std::exception& e) {
+        FinishJob(job, ModelData{}, true, e.what(), false);
+    } catch (...) {
+        FinishJob(job, ModelData{}, true, "Unknown error", false);
+    }
+}
+
+void ProceduralJobManager::FinishJob(const std::shared_ptr<Job>& job, ModelData result, bool failed, const std::string& errorMessage,
+                                     bool cacheHit) {
+    const uint64_t jobId = job->info.id;
+    ProceduralJobContext& context = *job->context;
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job->start).count();
+    bool cancelled = !failed && context.IsCancelled();
+    std::cout << "[ProceduralJobManager] 任务 " << jobId << "（" << job->info.algorithmName << "）"
+              << (failed ? "失败" : cancelled ? "已取消" : "完成") << (cacheHit ? "（命中缓存）" : "")
+              << "，耗时 " << elapsed << " ms" << std::endl;
+
+    if (failed) {
+        eventBus_->Enqueue(MyRenderer::Events::ProceduralGenerationCompletedEvent{false, errorMessage, ModelData{}, jobId});
+    } else if (cancelled) {
+        eventBus_->Enqueue(MyRenderer::Events::ProceduralGenerationStoppedEvent{jobId});
+    } else {
+        context.ReportProgress(1.0f);
+        eventBus_->Enqueue(MyRenderer::Events::ProceduralGenerationCompletedEvent{true, "", result, jobId});
+        if (job->cache && !cacheHit) {
+            job->cache->Store(job->cacheKey, ProceduralCache::Entry{std::move(result), context.TakeRecordedMeshes()});
+        }
+    }
+    if (job->cache) {
+        auto stats = job->cache->GetStats();
+        std::cout << "[ProceduralCache] 命中 " << stats.hits << "，未命中 " << stats.misses << "，条目 " << stats.entryCount
+                  << "，共 " << stats.totalBytes / (1024 * 1024) << " MB" << std::endl;
+    }
+
+    std::vector<std::shared_ptr<Job>> startable;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job->info.state = failed ? JobState::Failed : cancelled ? JobState::Cancelled : JobState::Completed;
+        job->info.progress = context.GetProgress();
+        job->info.workUnits = context.GetWorkUnits();
+        job->info.errorMessage = errorMessage;
+        // 任务对象随线程池任务一起释放，不再持有生成器与准备结果，避免线程池在自己的工作线程上析构
+        job->params = nlohmann::json();
+        job->generator.reset();
+        job->cache.reset();
+        context.SetPreparedData(std::any());
+        finishedJobs_.push_back(jobId);
+        TrimFinishedJobs();
+        runningCount_--;
+        startable = TakeStartableJobs();
+        if (runningCount_ == 0) idleCondition_.notify_all();
+    }
+    Launch(startable);
+}
+
+void ProceduralJobManager::TrimFinishedJobs() {
+    while (finishedJobs_.size() > kMaxFinishedJobs) {
+        jobs_.erase(finishedJobs_.front());
+        finishedJobs_.pop_front();
+    }
+}
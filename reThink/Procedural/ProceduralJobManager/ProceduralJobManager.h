@@ -0,0 +1,130 @@
+﻿#pragma once
+#include <map>
+#include <deque>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <string>
+#include <optional>
+#include <condition_variable>
+#include "IProceduralGenerator/IProceduralGenerator.h"
+#include "ProceduralCache/ProceduralCache.h"
+#include "ThreadPool/ThreadPool.h"
+
+/**
+ * @brief 程序化生成任务管理器。
+ *
+ * 订阅 RequestModelCreatedEvent，按算法名称找到已注册的生成器，为每次请求分配任务 ID
+ * 并作为线程池任务执行；RequestGenerationCancelEvent 取消指定任务（jobId 为 0 时取消全部）。
+ * 同时运行的任务数有上限，超出的任务按提交顺序排队。任务的开始、进度、分块、完成与停止
+ * 事件都带有任务 ID，任务状态也可以随时查询。这些事件在工作线程上入队，由主线程的
+ * DispatchQueued 统一分发，订阅者无需考虑线程安全；不同类型事件之间不保证先后顺序。
+ *
+ * 设置了结果缓存时，任务先按参数查找缓存，命中则直接重放缓存的网格块而不运行生成器；
+ * 未命中的任务成功完成后把输出写入缓存。
+ *
+ * 任务分两步执行：先查找缓存并调用生成器的 Prepare 发起所需的其他线程池任务，
+ * 这些任务完成后再作为依赖它们的任务图节点执行 Generate。生成器不在工作线程上阻塞等待，
+ * 因此并发上限与线程数无关，单线程的线程池也能完成任务。
+ */
+class ProceduralJobManager {
+public:
+    enum class JobState {
+        Queued,     // 等待空闲的执行槽
+        Running,    // 正在执行
+        Completed,  // 成功完成
+        Failed,     // 生成器抛出异常
+        Cancelled   // 排队或执行中被取消
+    };
+
+    /**
+     * @brief 任务状态快照。
+     */
+    struct JobInfo {
+        uint64_t id = 0;
+        std::string algorithmName;
+        JobState state = JobState::Queued;
+        float progress = 0.0f;
+        uint64_t workUnits = 0;   // 生成器报告的工作量，任务结束后有效
+        std::string errorMessage; // 失败时的原因
+    };
+
+    ProceduralJobManager(std::shared_ptr<EventBus> eventBus, std::shared_ptr<ThreadPool> threadPool, size_t maxConcurrentJobs = 2);
+
+    // 取消全部任务并等待正在执行的任务退出
+    ~ProceduralJobManager();
+
+    ProceduralJobManager(const ProceduralJobManager&) = delete;
+    ProceduralJobManager& operator=(const ProceduralJobManager&) = delete;
+
+    /**
+     * @brief 注册生成器，同名生成器会被替换。
+     */
+    void RegisterGenerator(std::shared_ptr<IProceduralGenerator> generator);
+
+    /**
+     * @brief 提交生成任务。
+     * @return 任务 ID；算法未注册时抛出 std::invalid_argument。
+     */
+    uint64_t Submit(const std::string& algorithmName, const nlohmann::json& params);
+
+    /**
+     * @brief 取消任务：排队中的任务直接移除，执行中的任务通过取消标志通知生成器。
+     * @return 任务存在且尚未结束时返回 true。
+     */
+    bool Cancel(uint64_t jobId);
+    void CancelAll();
+
+    std::optional<JobInfo> GetJob(uint64_t jobId) const;
+    std::vector<JobInfo> GetJobs() const;
+
+    void SetMaxConcurrentJobs(size_t maxConcurrentJobs);
+    size_t GetMaxConcurrentJobs() const;
+
+    /**
+     * @brief 设置结果缓存，传入空指针则不使用缓存；只影响之后提交的任务。
+     */
+    void SetCache(std::shared_ptr<ProceduralCache> cache);
+    std::shared_ptr<ProceduralCache> GetCache() const;
+
+private:
+    struct Job {
+        JobInfo info;
+        nlohmann::json params;
+        std::shared_ptr<IProceduralGenerator> generator;
+        std::shared_ptr<ProceduralJobContext> context;
+        std::shared_ptr<ProceduralCache> cache;
+        std::string cacheKey;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void SubscribeToEvents();
+    // 在持有 mutex_ 时调用，取出可以开始的排队任务
+    std::vector<std::shared_ptr<Job>> TakeStartableJobs();
+    void Launch(const std::vector<std::shared_ptr<Job>>& jobs);
+    // 查找缓存，未命中时调用 Prepare 并在其任务完成后调度 RunGenerator
+    void RunJob(const std::shared_ptr<Job>& job);
+    void RunGenerator(const std::shared_ptr<Job>& job);
+    // 发布结果、写入缓存并释放执行槽
+    void FinishJob(const std::shared_ptr<Job>& job, ModelData result, bool failed, const std::string& errorMessage, bool cacheHit);
+    // 在持有 mutex_ 时调用，只保留最近的若干个已结束任务
+    void TrimFinishedJobs();
+
+    std::shared_ptr<EventBus> eventBus_;
+    std::shared_ptr<ThreadPool> threadPool_;
+    size_t maxConcurrentJobs_;
+    std::shared_ptr<ProceduralCache> cache_;
+    EventBus::SubscriberId requestSubscription_;
+    EventBus::SubscriberId cancelSubscription_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable idleCondition_;
+    std::map<std::string, std::shared_ptr<IProceduralGenerator>> generators_;
+    std::map<uint64_t, std::shared_ptr<Job>> jobs_;
+    std::deque<std::shared_ptr<Job>> queue_;
+    std::deque<uint64_t> finishedJobs_;
+    size_t runningCount_;
+    uint64_t nextJobId_;
+    bool shuttingDown_;
+};
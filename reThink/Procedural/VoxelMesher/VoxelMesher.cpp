@@ -0,0 +1,134 @@
+﻿#include "VoxelMesher.h"
+
+namespace {
+    /**
+     * @brief 追加一个矩形面：plane 为面在 d 轴上的坐标，(u0, v0) 起点，(du, dv) 尺寸，sign 为法线朝向。
+     */
+    void AppendQuad(ModelData& mesh, int d, int u, int v, float plane, float u0, float v0, float du, float dv, int sign) {
+        glm::vec3 corners[4];
+        const float us[4] = {u0, u0 + du, u0 + du, u0};
+        const float vs[4] = {v0, v0, v0 + dv, v0 + dv};
+        for (int k = 0; k < 4; ++k) {
+            float p[3];
+            p[d] = plane;
+            p[u] = us[k];
+            p[v] = vs[k];
+            corners[k] = glm::vec3(p[0], p[1], p[2]);
+        }
+        float n[3] = {0.0f, 0.0f, 0.0f};
+        n[d] = static_cast<float>(sign);
+        glm::vec3 normal(n[0], n[1], n[2]);
+
+        unsigned int base = static_cast<unsigned int>(mesh.vertices.size());
+        for (int k = 0; k < 4; ++k) {
+            mesh.vertices.push_back(corners[k]);
+            mesh.normals.push_back(normal);
+        }
+        // (u, v, d) 构成右手系，按 u→v 逆时针排列时正面朝向 +d，朝向 -d 时反转绕序
+        if (sign > 0) {
+            mesh.indices.insert(mesh.indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+        } else {
+            mesh.indices.insert(mesh.indices.end(), {base, base + 2, base + 1, base, base + 3, base + 2});
+        }
+    }
+}
+
+ModelData VoxelMesher::BuildChunk(const std::vector<int>& cells, const std::vector<uint8_t>& solidLabels,
+                                  int width, int height, int depth, int x0, int z0, int chunkWidth, int chunkDepth,
+                                  Stats* stats) {
+    ModelData mesh;
+    mesh.filepath = "";
+    mesh.transform = glm::mat4(1.0f);
+    mesh.vertexShaderPath = "Shaders/default.vs";
+    mesh.fragmentShaderPath = "Shaders/default.fs";
+
+    // 复制块及其外围一圈单元格的实心标记，之后的查询不再做边界判断
+    const int size[3] = {chunkWidth, height, chunkDepth};
+    const size_t stride[3] = {static_cast<size_t>(chunkDepth + 2), static_cast<size_t>(chunkWidth + 2) * (chunkDepth + 2), 1};
+    std::vector<uint8_t> solid(static_cast<size_t>(chunkWidth + 2) * (height + 2) * (chunkDepth + 2), 0);
+    size_t solidCells = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = x0 - 1; x <= x0 + chunkWidth; ++x) {
+            if (x < 0 || x >= width) continue;
+            for (int z = z0 - 1; z <= z0 + chunkDepth; ++z) {
+                if (z < 0 || z >= depth) continue;
+                int label = cells[(static_cast<size_t>(y) * width + x) * depth + z];
+                if (label < 0 || !solidLabels[label]) continue;
+                solid[(y + 1) * stride[1] + (x - x0 + 1) * stride[0] + (z - z0 + 1)] = 1;
+                if (x >= x0 && x < x0 + chunkWidth && z >= z0 && z < z0 + chunkDepth) {
+                    solidCells++;
+                }
+            }
+        }
+    }
+
+    size_t visibleFaces = 0, quads = 0;
+    std::vector<int8_t> mask;
+    for (int d = 0; d < 3; ++d) {
+        const int u = (d + 1) % 3;
+        const int v = (d + 2) % 3;
+        mask.assign(static_cast<size_t>(size[u]) * size[v], 0);
+
+        // 逐个切片处理单元格 s 与 s + 1 之间的面，面归属于其中的实心单元格所在的块
+        for (int s = -1; s < size[d]; ++s) {
+            for (int j = 0; j < size[v]; ++j) {
+                for (int i = 0; i < size[u]; ++i) {
+                    size_t a = (s + 1) * stride[d] + (i + 1) * stride[u] + (j + 1) * stride[v];
+                    size_t b = a + stride[d];
+                    int8_t m = 0;
+                    if (solid[a] && !solid[b] && s >= 0) {
+                        m = 1;
+                    } else if (solid[b] && !solid[a] && s + 1 < size[d]) {
+                        m = -1;
+                    }
+                    mask[static_cast<size_t>(j) * size[u] + i] = m;
+                    visibleFaces += m != 0;
+                }
+            }
+
+            // 贪心合并：先沿 u 方向延伸，再沿 v 方向整行延伸
+            for (int j = 0; j < size[v]; ++j) {
+                for (int i = 0; i < size[u];) {
+                    int8_t m = mask[static_cast<size_t>(j) * size[u] + i];
+                    if (m == 0) {
+                        ++i;
+                        continue;
+                    }
+                    int w = 1;
+                    while (i + w < size[u] && mask[static_cast<size_t>(j) * size[u] + i + w] == m) {
+                        ++w;
+                    }
+                    int h = 1;
+                    for (; j + h < size[v]; ++h) {
+                        bool rowMatches = true;
+                        for (int k = 0; k < w; ++k) {
+                            if (mask[static_cast<size_t>(j + h) * size[u] + i + k] != m) {
+                                rowMatches = false;
+                                break;
+                            }
+                        }
+                        if (!rowMatches) break;
+                    }
+                    for (int r = 0; r < h; ++r) {
+                        for (int k = 0; k < w; ++k) {
+                            mask[static_cast<size_t>(j + r) * size[u] + i + k] = 0;
+                        }
+                    }
+
+                    const float origin[3] = {static_cast<float>(x0), 0.0f, static_cast<float>(z0)};
+                    AppendQuad(mesh, d, u, v, origin[d] + s + 0.5f, origin[u] + i - 0.5f, origin[v] + j - 0.5f,
+                               static_cast<float>(w), static_cast<float>(h), m);
+                    quads++;
+                    i += w;
+                }
+            }
+        }
+    }
+
+    if (stats) {
+        stats->solidCells = solidCells;
+        stats->visibleFaces = visibleFaces;
+        stats->quads = quads;
+    }
+    return mesh;
+}
@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <vector>
+#include <cstdint>
+#include "EventBus/EventTypes.h"
+
+/**
+ * @brief 网格类程序化输出的体素网格化。
+ *
+ * 输入为按 (y * width + x) * depth + z 排列的单元格标签，标签对应的 solidLabels 项非零时单元格视为实心，
+ * 每个实心单元格是以单元格坐标为中心的单位立方体。生成时只保留实心与空心单元格之间的面，
+ * 完全被遮挡的内部面直接剔除；同一切片内朝向相同的可见面再贪心合并为尽可能大的矩形。
+ *
+ * 网格可按 x/z 分块生成，块边界上的面按所属的实心单元格归入对应的块，剔除时参考整个网格，
+ * 因此各块拼接后与整体生成的结果一致。
+ */
+class VoxelMesher {
+public:
+    /**
+     * @brief 网格化统计。
+     */
+    struct Stats {
+        size_t solidCells = 0;    // 实心单元格数量
+        size_t visibleFaces = 0;  // 剔除内部面后剩余的单位面数量
+        size_t quads = 0;         // 贪心合并后的矩形数量
+    };
+
+    /**
+     * @brief 生成 x ∈ [x0, x0 + chunkWidth)、z ∈ [z0, z0 + chunkDepth)、y 完整范围内单元格的网格。
+     * @param cells 单元格标签，负数表示空。
+     * @param solidLabels 标签是否为实心。
+     * @param stats 可选的统计输出。
+     */
+    static ModelData BuildChunk(const std::vector<int>& cells, const std::vector<uint8_t>& solidLabels,
+                                int width, int height, int depth, int x0, int z0, int chunkWidth, int chunkDepth,
+                                Stats* stats = nullptr);
+};
@@ -0,0 +1,71 @@
+﻿#include "WFCBenchmark.h"
+#include "WFCSolver.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "Utils/ProcessMemory.h"
+
+namespace {
+    /**
+     * @brief 生成合成瓦片集与数组形式的邻接规则。
+     */
+    std::pair<std::vector<std::string>, nlohmann::json> MakeSyntheticRules(size_t tileCount) {
+        std::vector<std::string> tileSet;
+        for (size_t i = 0; i < tileCount; ++i) {
+            tileSet.push_back("tile" + std::to_string(i));
+        }
+        nlohmann::json rules = nlohmann::json::object();
+        for (size_t i = 0; i < tileCount; ++i) {
+            rules[tileSet[i]] = {tileSet[i], tileSet[(i + 1) % tileCount], tileSet[(i + 5) % tileCount], tileSet[(i + 17) % tileCount]};
+        }
+        return {tileSet, rules};
+    }
+}
+
+int WFCBenchmark::RunCommandLine(int argc, char** argv) {
+    int size = 128;
+    size_t tileCount = 64;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bench-wfc") {
+            continue;
+        } else if (arg == "--size" && i + 1 < argc) {
+            size = std::atoi(argv[++i]);
+        } else if (arg == "--tiles" && i + 1 < argc) {
+            tileCount = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            size = 0;
+            break;
+        }
+    }
+    if (size <= 0 || tileCount == 0) {
+        std::cerr << "用法: reThink --bench-wfc [--size <边长>] [--tiles <瓦片数>] [--seed <种子>]" << std::endl;
+        return 2;
+    }
+
+    try {
+        auto [tileSet, rules] = MakeSyntheticRules(tileCount);
+        auto start = std::chrono::steady_clock::now();
+        WFCSolver solver(tileSet, rules);
+        solver.Reset(size, size, size);
+        auto prepared = std::chrono::steady_clock::now();
+        bool solved = solver.Solve(seed);
+        auto finished = std::chrono::steady_clock::now();
+
+        double prepareSeconds = std::chrono::duration<double>(prepared - start).count();
+        double solveSeconds = std::chrono::duration<double>(finished - prepared).count();
+        double cells = static_cast<double>(size) * size * size;
+        std::cout << "[WFCBench] " << size << "^3 网格，" << tileCount << " 个瓦片，种子 " << seed << std::endl;
+        std::cout << "[WFCBench] 编译规则与初始化 " << prepareSeconds * 1000.0 << " ms，求解 " << solveSeconds << " s（"
+                  << cells / solveSeconds << " cells/s）" << std::endl;
+        std::cout << "[WFCBench] " << (solved ? "求解成功" : "求解失败") << "，已确定 " << solver.GetCollapsedCount() << " 个单元格，回溯 "
+                  << solver.GetBacktrackCount() << " 次，内存峰值 " << ProcessMemory::GetPeakBytes() / (1024 * 1024) << " MB" << std::endl;
+        return solved ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "[WFCBench] " << e.what() << std::endl;
+        return 1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+﻿#pragma once
+
+/**
+ * @brief WFCSolver 的无界面基准：在合成的瓦片规则上求解立方体网格并输出耗时。
+ *
+ * 合成规则中瓦片 i 可与 i、i+1、i+5、i+17（对瓦片数取模）相邻，约束较松但不平凡，
+ * 结果只取决于尺寸、瓦片数与种子，便于比较不同版本的求解器。
+ * 命令行入口：reThink --bench-wfc [--size <边长>] [--tiles <瓦片数>] [--seed <种子>]
+ */
+class WFCBenchmark {
+public:
+    /**
+     * @brief 命令行入口，求解成功时返回 0。
+     */
+    static int RunCommandLine(int argc, char** argv);
+};
\ No newline at end of file
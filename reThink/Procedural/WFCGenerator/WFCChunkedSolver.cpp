@@ -0,0 +1,133 @@
+﻿#include "WFCChunkedSolver.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    // 每个块在同一阶段内的尝试次数（每次使用不同种子）
+    constexpr uint32_t kRegionAttempts = 3;
+    // 接缝重解时区域向四周扩展的初始单元格数，每轮重试翻倍
+    constexpr int kSeamMargin = 4;
+    constexpr int kSeamRounds = 3;
+}
+
+WFCChunkedSolver::WFCChunkedSolver(const WFCSolver& prototype, std::shared_ptr<ThreadPool> threadPool)
+    : prototype_(prototype), threadPool_(threadPool) {
+    if (!threadPool_) throw std::invalid_argument("WFCChunkedSolver: ThreadPool cannot be null");
+}
+
+uint32_t WFCChunkedSolver::RegionSeed(uint32_t seed, const Region& region, uint32_t attempt) const {
+    // splitmix64 混合全局种子、块坐标与尝试次数
+    uint64_t value = (static_cast<uint64_t>(seed) << 32) ^ (static_cast<uint64_t>(region.x0) << 20) ^
+                     (static_cast<uint64_t>(region.z0) << 4) ^ attempt;
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<uint32_t>(value ^ (value >> 31));
+}
+
+bool WFCChunkedSolver::SolveRegion(const Region& region, uint32_t seed, bool reSolve, const std::atomic<bool>* cancelled) {
+    WFCSolver solver = prototype_;
+    solver.Reset(region.width, height_, region.depth);
+
+    // 以区域外已确定的单元格约束区域的四个侧面
+    for (int y = 0; y < height_; ++y) {
+        for (int z = 0; z < region.depth; ++z) {
+            int gz = region.z0 + z;
+            if (region.x0 > 0) {
+                int tile = GetTile(region.x0 - 1, y, gz);
+                if (tile >= 0 && !solver.Restrict(0, y, z, WFCSolver::NegX, tile)) return false;
+            }
+            if (region.x0 + region.width < width_) {
+                int tile = GetTile(region.x0 + region.width, y, gz);
+                if (tile >= 0 && !solver.Restrict(region.width - 1, y, z, WFCSolver::PosX, tile)) return false;
+            }
+        }
+        for (int x = 0; x < region.width; ++x) {
+            int gx = region.x0 + x;
+            if (region.z0 > 0) {
+                int tile = GetTile(gx, y, region.z0 - 1);
+                if (tile >= 0 && !solver.Restrict(x, y, 0, WFCSolver::NegZ, tile)) return false;
+            }
+            if (region.z0 + region.depth < depth_) {
+                int tile = GetTile(gx, y, region.z0 + region.depth);
+                if (tile >= 0 && !solver.Restrict(x, y, region.depth - 1, WFCSolver::PosZ, tile)) return false;
+            }
+        }
+    }
+    if (!solver.ApplyConstraints() || !solver.Solve(seed, cancelled)) {
+        return false;
+    }
+
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < region.width; ++x) {
+            for (int z = 0; z < region.depth; ++z) {
+                tiles_[(static_cast<size_t>(y) * width_ + region.x0 + x) * depth_ + region.z0 + z] = solver.GetTile(x, y, z);
+            }
+        }
+    }
+    if (regionCallback_) {
+        regionCallback_(region.x0, region.z0, region.width, region.depth, reSolve);
+    }
+    return true;
+}
+
+bool WFCChunkedSolver::Solve(int width, int height, int depth, int chunkSize, uint32_t seed, const std::atomic<bool>* cancelled) {
+    if (width <= 0 || height <= 0 || depth <= 0 || chunkSize <= 0) {
+        throw std::invalid_argument("WFCChunkedSolver: Grid dimensions and chunk size must be positive");
+    }
+    width_ = width;
+    height_ = height;
+    depth_ = depth;
+    tiles_.assign(static_cast<size_t>(width) * height * depth, -1);
+    stats_ = Stats{};
+
+    // 按棋盘格划分两个阶段
+    std::vector<Region> phases[2];
+    for (int cx = 0; cx * chunkSize < width; ++cx) {
+        for (int cz = 0; cz * chunkSize < depth; ++cz) {
+            Region region{cx * chunkSize, cz * chunkSize,
+                          std::min(chunkSize, width - cx * chunkSize), std::min(chunkSize, depth - cz * chunkSize)};
+            phases[(cx + cz) % 2].push_back(region);
+        }
+    }
+    stats_.chunkCount = phases[0].size() + phases[1].size();
+
+    std::vector<Region> failed;
+    for (auto& phase : phases) {
+        std::vector<uint8_t> solved(phase.size(), 0);
+        threadPool_->ParallelFor(0, phase.size(), 1, [&](size_t i) {
+            for (uint32_t attempt = 0; attempt < kRegionAttempts && !(cancelled && *cancelled); ++attempt) {
+                if (SolveRegion(phase[i], RegionSeed(seed, phase[i], attempt), false, cancelled)) {
+                    solved[i] = 1;
+                    return;
+                }
+            }
+        });
+        if (cancelled && *cancelled) return false;
+        for (size_t i = 0; i < phase.size(); ++i) {
+            if (!solved[i]) failed.push_back(phase[i]);
+        }
+    }
+    stats_.failedChunks = failed.size();
+
+    // 串行重解失败块：扩展区域并以区域外的结果为约束
+    for (const Region& chunk : failed) {
+        bool resolved = false;
+        for (int round = 0; round < kSeamRounds && !resolved; ++round) {
+            int margin = kSeamMargin << round;
+            int x0 = std::max(0, chunk.x0 - margin);
+            int z0 = std::max(0, chunk.z0 - margin);
+            Region region{x0, z0,
+                          std::min(width_, chunk.x0 + chunk.width + margin) - x0,
+                          std::min(depth_, chunk.z0 + chunk.depth + margin) - z0};
+            for (uint32_t attempt = 0; attempt < kRegionAttempts && !resolved; ++attempt) {
+                if (cancelled && *cancelled) return false;
+                stats_.reSolves++;
+                resolved = SolveRegion(region, RegionSeed(seed, region, kRegionAttempts + round * kRegionAttempts + attempt), true, cancelled);
+            }
+        }
+    }
+
+    stats_.unresolvedCells = static_cast<size_t>(std::count(tiles_.begin(), tiles_.end(), -1));
+    return stats_.unresolvedCells == 0;
+}
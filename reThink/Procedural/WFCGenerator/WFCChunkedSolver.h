@@ -0,0 +1,78 @@
+﻿#pragma once
+#include "WFCSolver.h"
+#include "ThreadPool/ThreadPool.h"
+#include <memory>
+#include <functional>
+
+/**
+ * @brief 分块并行的波函数坍缩求解器，用于超大网格。
+ *
+ * 网格沿 x/z 方向划分为若干块，y 方向保持完整。按棋盘格分两个阶段求解：
+ * 1. 偶数块彼此不相邻，在线程池中并行独立求解；
+ * 2. 奇数块的四个侧面邻居均已确定，以其边界瓦片为约束并行求解。
+ * 仍然失败的块在最后串行重解：区域向四周扩展若干单元格，清除扩展区域内的结果，
+ * 以区域外已确定的单元格为约束重新求解，扩展范围随重试次数增大。
+ *
+ * 每块的种子由全局种子与块坐标决定，因此结果与线程数量和调度顺序无关。
+ * 每个区域求解成功后立即通过区域回调通知调用方，便于边求解边输出。
+ */
+class WFCChunkedSolver {
+public:
+    /**
+     * @brief 分块求解统计。
+     */
+    struct Stats {
+        size_t chunkCount = 0;      // 块数量
+        size_t failedChunks = 0;    // 两个阶段后仍失败的块数量
+        size_t reSolves = 0;        // 接缝重解次数
+        size_t unresolvedCells = 0; // 最终仍未确定的单元格数量
+    };
+
+    /**
+     * @brief 区域求解成功回调，参数为区域在 x/z 方向的起点与尺寸（y 方向始终完整）。
+     * 两个并行阶段中回调在线程池线程上并发调用，各次回调的区域恰为一个块且互不重叠；
+     * reSolve 为 true 时是串行的接缝重解，区域可能覆盖此前已回调过的块。
+     */
+    using RegionCallback = std::function<void(int x0, int z0, int width, int depth, bool reSolve)>;
+
+    /**
+     * @param prototype 已编译规则的求解器，每个块复制一份使用。
+     * @param threadPool 用于并行求解各块的线程池。
+     */
+    WFCChunkedSolver(const WFCSolver& prototype, std::shared_ptr<ThreadPool> threadPool);
+
+    /**
+     * @brief 求解整个网格。
+     * @param chunkSize 块在 x/z 方向的边长（单元格数量）。
+     * @return 所有单元格均已确定时返回 true。
+     */
+    bool Solve(int width, int height, int depth, int chunkSize, uint32_t seed, const std::atomic<bool>* cancelled = nullptr);
+
+    void SetRegionCallback(RegionCallback callback) { regionCallback_ = std::move(callback); }
+
+    /**
+     * @brief 获取求解结果，布局与 WFCSolver 相同，未确定的单元格为 -1。
+     */
+    const std::vector<int>& GetTiles() const { return tiles_; }
+
+    int GetTile(int x, int y, int z) const { return tiles_[(static_cast<size_t>(y) * width_ + x) * depth_ + z]; }
+    int GetWidth() const { return width_; }
+    int GetHeight() const { return height_; }
+    int GetDepth() const { return depth_; }
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    struct Region {
+        int x0, z0, width, depth;
+    };
+
+    bool SolveRegion(const Region& region, uint32_t seed, bool reSolve, const std::atomic<bool>* cancelled);
+    uint32_t RegionSeed(uint32_t seed, const Region& region, uint32_t attempt) const;
+
+    WFCSolver prototype_;
+    std::shared_ptr<ThreadPool> threadPool_;
+    int width_ = 0, height_ = 0, depth_ = 0;
+    std::vector<int> tiles_;
+    Stats stats_;
+    RegionCallback regionCallback_;
+};
@@ -1,64 +1,49 @@
 ﻿#include "WFCGenerator.h"
 #include <chrono>
 #include <random>
+#include <any>
 #include <future>
+#include <iostream>
+#include <algorithm>
 #include "Utils/MathUtils.h"
+#include "VoxelMesher/VoxelMesher.h"
 
-WFCGenerator::WFCGenerator(std::shared_ptr<ModelLoader> modelLoader) 
-    : modelLoader_(modelLoader), cancelled_(false) {
-    if (!modelLoader_) throw std::invalid_argument("WFCGenerator: ModelLoader cannot be null");
-}
-
-WFCGenerator::~WFCGenerator() {
-    if (generationThread_.joinable()) {
-        Cancel();
-        generationThread_.join();
-    }
-}
-
-void WFCGenerator::Generate(const nlohmann::json& params, std::shared_ptr<EventBus> eventBus) {
-    cancelled_ = false;
-    if (generationThread_.joinable()) {
-        generationThread_.join();
-    }
-    generationThread_ = std::thread(&WFCGenerator::RunGeneration, this, params, eventBus);
+namespace {
+    // 可撤销的最近决策数量
+    constexpr size_t kMaxBacktrackDepth = 64;
+    // chunkSize 为 0 时，单元格数量超过该值才分块求解，分块边长取 kDefaultChunkSize
+    constexpr size_t kChunkedCellThreshold = 64 * 64 * 64;
+    constexpr int kDefaultChunkSize = 32;
+    // 单块求解时进度回调的次数
+    constexpr size_t kProgressSteps = 100;
+    // 名称为该值的瓦片表示空单元格，不加载模型也不输出几何
+    constexpr const char* kEmptyTileName = "empty";
 }
 
-void WFCGenerator::Cancel() {
-    cancelled_ = true;
+WFCGenerator::WFCGenerator(std::shared_ptr<ModelLoader> modelLoader, std::shared_ptr<ThreadPool> threadPool) 
+    : modelLoader_(modelLoader), threadPool_(threadPool) {
+    if (!modelLoader_) throw std::invalid_argument("WFCGenerator: ModelLoader cannot be null");
+    if (!threadPool_) throw std::invalid_argument("WFCGenerator: ThreadPool cannot be null");
 }
 
-void WFCGenerator::RunGeneration(const nlohmann::json& params, std::shared_ptr<EventBus> eventBus) {
-    eventBus->Publish(MyRenderer::Events::ProceduralGenerationStartedEvent{});
-
+ModelData WFCGenerator::Generate(const nlohmann::json& params, ProceduralJobContext& context) {
     std::vector<std::string> tileSet = params.value("tileSet", std::vector<std::string>{});
     int width = params.value("width", 10);
     int height = params.value("height", 10);
     int depth = params.value("depth", 10);
     nlohmann::json adjacencyRules = params.value("adjacencyRules", nlohmann::json::object());
+    GridOptions options;
+    options.seed = params.value("seed", 0u);
+    options.maxBacktracks = params.value("maxBacktracks", 1000u);
+    options.chunkSize = params.value("chunkSize", 0);
+    options.instanced = params.value("instanced", false);
+    options.voxelize = params.value("voxelize", false);
 
     if (tileSet.empty()) {
-        eventBus->Publish(MyRenderer::Events::ProceduralGenerationCompletedEvent{false, "No tiles provided", ModelData{}});
-        return;
+        throw std::invalid_argument("No tiles provided");
     }
 
-    ModelData modelData = GenerateGrid(tileSet, adjacencyRules, width, height, depth);
-
-    for (int i = 0; i <= 100; i += 10) {
-        if (cancelled_) {
-            eventBus->Publish(MyRenderer::Events::ProceduralGenerationStoppedEvent{});
-            return;
-        }
-        eventBus->Publish(MyRenderer::Events::ProgressUpdateEvent{static_cast<float>(i) / 100.0f});
-        std::this_thread::sleep_for(std::chrono::milliseconds(100)); // 模拟耗时
-    }
-
-    if (!cancelled_) {
-        eventBus->Publish(MyRenderer::Events::ProceduralGenerationCompletedEvent{true, "", modelData});
-    }
-}
-
-ModelData WFCGenerator::GenerateGrid(const std::vector<std::string>& tileSet, const nlohmann::json& adjacencyRules, int width, int height, int depth) {
+    // 结果本身不含几何数据，网格按块通过 ProceduralChunkReadyEvent 输出，各块以此为父节点
     ModelData modelData;
     modelData.uuid = "wfc_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
     modelData.filepath = "";
@@ -67,106 +52,305 @@ ModelData WFCGenerator::GenerateGrid(const std::vector<std::string>& tileSet, co
     modelData.fragmentShaderPath = "";
     modelData.parentUUID = "";
 
-    std::mt19937 gen(std::random_device{}());
-    std::uniform_int_distribution<> tileDist(0, tileSet.size() - 1);
+    if (GenerateGrid(tileSet, adjacencyRules, width, height, depth, options, modelData.uuid, context)) {
+        context.AddWorkUnits(static_cast<uint64_t>(width) * height * depth);
+    }
+    return modelData;
+}
 
-    // 初始化网格，所有单元格初始包含所有可能瓦片
-    std::vector<std::vector<std::vector<Cell>>> grid(height, std::vector<std::vector<Cell>>(width, std::vector<Cell>(depth)));
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            for (int z = 0; z < depth; z++) {
-                for (int i = 0; i < tileSet.size(); i++) {
-                    grid[y][x][z].possibleTiles.push_back(i);
-                }
-            }
+std::vector<ThreadPool::TaskHandle> WFCGenerator::Prepare(const nlohmann::json& params, ProceduralJobContext& context) {
+    // 体素输出不需要瓦片模型
+    if (params.value("voxelize", false)) return {};
+    TileLoads loads = modelLoader_->LoadModelsTask(GetMeshFiles(params.value("tileSet", std::vector<std::string>{})));
+    context.SetPreparedData(loads);
+    return {loads};
+}
+
+std::vector<std::string> WFCGenerator::GetInputFiles(const nlohmann::json& params) const {
+    return GetMeshFiles(params.value("tileSet", std::vector<std::string>{}));
+}
+
+std::vector<std::string> WFCGenerator::GetMeshFiles(const std::vector<std::string>& tileSet) {
+    std::vector<std::string> files;
+    for (const auto& tile : tileSet) {
+        if (tile != kEmptyTileName) files.push_back(tile);
+    }
+    return files;
+}
+
+bool WFCGenerator::GenerateGrid(const std::vector<std::string>& tileSet, const nlohmann::json& adjacencyRules, int width, int height, int depth,
+                                const GridOptions& options, const std::string& parentUUID, ProceduralJobContext& context) {
+    std::vector<uint8_t> solidTiles(tileSet.size());
+    for (size_t i = 0; i < tileSet.size(); ++i) {
+        solidTiles[i] = tileSet[i] != kEmptyTileName;
+    }
+
+    // 瓦片模型由 Prepare 发起加载，任务管理器在加载完成后才调用 Generate，这里读取结果不会阻塞；
+    // 求解前模型已就绪，各块求解完毕即可生成网格
+    std::vector<ModelData> tileModels(tileSet.size());
+    if (!options.voxelize) {
+        const TileLoads* loads = std::any_cast<TileLoads>(&context.GetPreparedData());
+        if (!loads || !loads->IsReady()) {
+            throw std::logic_error("WFCGenerator: 瓦片模型须由 Prepare 加载完成后再调用 Generate");
+        }
+        std::vector<ModelData> loaded = loads->Get();
+        for (size_t i = 0, next = 0; i < tileSet.size(); ++i) {
+            if (solidTiles[i]) tileModels[i] = std::move(loaded[next++]);
         }
     }
 
-    // 从随机位置开始坍缩
-    int startX = width / 2, startY = height / 2, startZ = depth / 2;
-    Collapse(grid, startX, startY, startZ, tileSet, adjacencyRules);
-    Propagate(grid, startX, startY, startZ, tileSet, adjacencyRules);
+    // 规则只编译一次，求解过程只做位运算；相同种子得到相同布局
+    WFCSolver solver(tileSet, adjacencyRules);
+    solver.SetBacktrackLimits(kMaxBacktrackDepth, options.maxBacktracks);
 
-    // 生成模型数据
-    std::map<std::string, ModelData> loadedTiles;
-    for (const auto& tilePath : tileSet) {
-        auto future = modelLoader_->LoadModelAsync(tilePath);
-        loadedTiles[tilePath] = future.get();
+    size_t cellCount = static_cast<size_t>(width) * height * depth;
+    int chunkSize = options.chunkSize;
+    if (chunkSize <= 0 && cellCount > kChunkedCellThreshold) {
+        chunkSize = kDefaultChunkSize;
     }
+    bool chunked = chunkSize > 0 && (chunkSize < width || chunkSize < depth);
+
+    // 输出网格按 x/z 分块，分块求解时与求解块一致
+    int meshChunkSize = chunkSize > 0 ? chunkSize : kDefaultChunkSize;
+    size_t chunksX = (width + meshChunkSize - 1) / meshChunkSize;
+    size_t chunksZ = (depth + meshChunkSize - 1) / meshChunkSize;
+    size_t chunkCount = chunksX * chunksZ;
+    auto forEachChunk = [&](int x0, int z0, int regionWidth, int regionDepth, auto&& fn) {
+        int x1 = std::min(width, x0 + regionWidth) - 1, z1 = std::min(depth, z0 + regionDepth) - 1;
+        for (size_t cx = std::max(x0, 0) / meshChunkSize; cx <= static_cast<size_t>(x1 / meshChunkSize); ++cx) {
+            for (size_t cz = std::max(z0, 0) / meshChunkSize; cz <= static_cast<size_t>(z1 / meshChunkSize); ++cz) {
+                fn(cx, cz);
+            }
+        }
+    };
 
-    for (int y = 0; y < height && !cancelled_; y++) {
-        for (int x = 0; x < width && !cancelled_; x++) {
-            for (int z = 0; z < depth && !cancelled_; z++) {
-                if (grid[y][x][z].collapsed && !grid[y][x][z].possibleTiles.empty()) {
-                    int tileIdx = grid[y][x][z].possibleTiles[0];
-                    const ModelData& tileData = loadedTiles[tileSet[tileIdx]];
-                    glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z));
-                    for (const auto& vertex : tileData.vertices) {
-                        glm::vec4 transformed = transform * glm::vec4(vertex, 1.0f);
-                        modelData.vertices.push_back(glm::vec3(transformed));
+    // 进度取自已确定的单元格数量，只在整数百分比增加时发布
+    std::atomic<int> lastPercent{-1};
+    auto reportProgress = [&](size_t resolvedCells) {
+        int percent = static_cast<int>(std::min<size_t>(resolvedCells * 100 / cellCount, 100));
+        int previous = lastPercent.load();
+        while (percent > previous) {
+            if (lastPercent.compare_exchange_weak(previous, percent)) {
+                context.ReportProgress(static_cast<float>(percent) / 100.0f);
+                break;
+            }
+        }
+    };
+
+    // 同一块不会被并发输出，各块的统计写入各自的槽位，最后汇总
+    std::vector<VoxelMesher::Stats> voxelStats(chunkCount);
+    std::vector<double> meshMilliseconds(chunkCount, 0.0);
+    std::vector<std::atomic<bool>> chunkEmitted(chunkCount);
+    auto emitChunk = [&](const std::vector<int>& tiles, size_t chunkX, size_t chunkZ) {
+        int x0 = static_cast<int>(chunkX) * meshChunkSize;
+        int z0 = static_cast<int>(chunkZ) * meshChunkSize;
+        int chunkWidth = std::min(meshChunkSize, width - x0);
+        int chunkDepth = std::min(meshChunkSize, depth - z0);
+        size_t chunkIndex = chunkX * chunksZ + chunkZ;
+        auto meshStart = std::chrono::steady_clock::now();
+        ModelData chunk = options.voxelize
+            ? VoxelMesher::BuildChunk(tiles, solidTiles, width, height, depth, x0, z0, chunkWidth, chunkDepth, &voxelStats[chunkIndex])
+            : BuildChunkMesh(tiles, width, height, depth, x0, z0, chunkWidth, chunkDepth, tileModels);
+        meshMilliseconds[chunkIndex] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - meshStart).count();
+        chunk.uuid = parentUUID + "_chunk_" + std::to_string(chunkIndex);
+        chunk.parentUUID = parentUUID;
+        chunkEmitted[chunkIndex] = true;
+        context.EmitMesh(std::move(chunk), chunkIndex, chunkCount);
+    };
+    auto emitRemainingChunks = [&](const std::vector<int>& tiles) {
+        threadPool_->ParallelFor(0, chunkCount, 1, [&](size_t chunkIndex) {
+            if (!chunkEmitted[chunkIndex]) {
+                emitChunk(tiles, chunkIndex / chunksZ, chunkIndex % chunksZ);
+            }
+        });
+    };
+    // 实例化输出在求解结束后一次性发送，每种瓦片一个网格
+    auto emitInstanced = [&](const std::vector<int>& tiles) {
+        std::vector<ModelData> models = BuildInstancedModels(tiles, width, height, depth, tileModels);
+        for (size_t i = 0; i < models.size(); ++i) {
+            models[i].parentUUID = parentUUID;
+            models[i].uuid = parentUUID + "_" + models[i].uuid;
+            context.EmitMesh(std::move(models[i]), i, models.size());
+        }
+    };
+    bool instanced = options.instanced && !options.voxelize;
+
+    auto start = std::chrono::steady_clock::now();
+    bool solved;
+    if (chunked) {
+        // 超大网格按块并行求解，每块求解成功后立即输出；接缝重解覆盖的块重新输出
+        WFCChunkedSolver chunkedSolver(solver, threadPool_);
+        std::vector<std::atomic<bool>> chunkSolved(chunkCount);
+        std::atomic<size_t> resolvedCells{0};
+        // 体素输出的面剔除依赖相邻块，块及其四个相邻块都求解后才输出
+        auto neighborsSolved = [&](size_t cx, size_t cz) {
+            return chunkSolved[cx * chunksZ + cz] &&
+                   (cx == 0 || chunkSolved[(cx - 1) * chunksZ + cz]) && (cx + 1 == chunksX || chunkSolved[(cx + 1) * chunksZ + cz]) &&
+                   (cz == 0 || chunkSolved[cx * chunksZ + cz - 1]) && (cz + 1 == chunksZ || chunkSolved[cx * chunksZ + cz + 1]);
+        };
+        chunkedSolver.SetRegionCallback([&](int x0, int z0, int regionWidth, int regionDepth, bool reSolve) {
+            const std::vector<int>& tiles = chunkedSolver.GetTiles();
+            forEachChunk(x0, z0, regionWidth, regionDepth, [&](size_t cx, size_t cz) {
+                if (!chunkSolved[cx * chunksZ + cz].exchange(true)) {
+                    size_t chunkCells = static_cast<size_t>(std::min(meshChunkSize, width - static_cast<int>(cx) * meshChunkSize)) *
+                                        std::min(meshChunkSize, depth - static_cast<int>(cz) * meshChunkSize) * height;
+                    reportProgress(resolvedCells += chunkCells);
+                }
+            });
+            if (instanced) return;
+            if (!options.voxelize) {
+                forEachChunk(x0, z0, regionWidth, regionDepth, [&](size_t cx, size_t cz) { emitChunk(tiles, cx, cz); });
+            } else if (reSolve) {
+                // 串行重解后，区域内的块及与其相邻的块都需重新生成
+                forEachChunk(x0 - 1, z0 - 1, regionWidth + 2, regionDepth + 2, [&](size_t cx, size_t cz) { emitChunk(tiles, cx, cz); });
+            } else {
+                forEachChunk(x0 - 1, z0 - 1, regionWidth + 2, regionDepth + 2, [&](size_t cx, size_t cz) {
+                    size_t chunkIndex = cx * chunksZ + cz;
+                    if (neighborsSolved(cx, cz) && !chunkEmitted[chunkIndex].exchange(true)) {
+                        emitChunk(tiles, cx, cz);
                     }
-                    int baseIdx = modelData.vertices.size() - tileData.vertices.size();
-                    for (const auto& idx : tileData.indices) {
-                        modelData.indices.push_back(baseIdx + idx);
+                });
+            }
+        });
+        solved = chunkedSolver.Solve(width, height, depth, chunkSize, options.seed, context.GetCancellationFlag());
+        const WFCChunkedSolver::Stats& stats = chunkedSolver.GetStats();
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[WFCGenerator] " << width << "x" << height << "x" << depth << " 分块求解耗时 " << elapsed
+                  << " ms，" << stats.chunkCount << " 块，失败 " << stats.failedChunks << " 块，接缝重解 " << stats.reSolves
+                  << " 次" << std::endl;
+        if (!context.IsCancelled()) {
+            // 未能求解的块及其相邻块输出已确定的单元格
+            if (instanced) {
+                emitInstanced(chunkedSolver.GetTiles());
+            } else {
+                emitRemainingChunks(chunkedSolver.GetTiles());
+            }
+        }
+    } else {
+        solver.SetProgressCallback(reportProgress, std::max<size_t>(cellCount / kProgressSteps, 1));
+        solver.Reset(width, height, depth);
+        solved = solver.Solve(options.seed, context.GetCancellationFlag());
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[WFCGenerator] " << width << "x" << height << "x" << depth << " 求解耗时 " << elapsed
+                  << " ms，回溯 " << solver.GetBacktrackCount() << " 次" << std::endl;
+        if (!context.IsCancelled()) {
+            std::vector<int> tiles(cellCount);
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    for (int z = 0; z < depth; z++) {
+                        tiles[(static_cast<size_t>(y) * width + x) * depth + z] = solver.GetTile(x, y, z);
                     }
                 }
             }
+            if (instanced) {
+                emitInstanced(tiles);
+            } else {
+                emitRemainingChunks(tiles);
+            }
         }
     }
-
-    return modelData;
+    if (!solved && !context.IsCancelled()) {
+        std::cerr << "[WFCGenerator] 求解未能消除全部矛盾，仅输出已确定的单元格" << std::endl;
+    }
+    if (options.voxelize && !context.IsCancelled()) {
+        VoxelMesher::Stats total;
+        double meshTime = 0.0;
+        for (size_t i = 0; i < chunkCount; ++i) {
+            total.solidCells += voxelStats[i].solidCells;
+            total.visibleFaces += voxelStats[i].visibleFaces;
+            total.quads += voxelStats[i].quads;
+            meshTime += meshMilliseconds[i];
+        }
+        std::cout << "[WFCGenerator] 体素网格 " << total.solidCells << " 个实心单元格：三角形 " << total.quads * 2
+                  << "（未剔除 " << total.solidCells * 12 << "，仅剔除 " << total.visibleFaces * 2 << "），网格化累计耗时 "
+                  << meshTime << " ms" << std::endl;
+    }
+    return solved;
 }
 
-void WFCGenerator::Collapse(std::vector<std::vector<std::vector<Cell>>>& grid, int x, int y, int z, const std::vector<std::string>& tileSet, const nlohmann::json& adjacencyRules) {
-    if (x < 0 || x >= grid[0].size() || y < 0 || y >= grid.size() || z < 0 || z >= grid[0][0].size() || grid[y][x][z].collapsed) return;
+std::vector<ModelData> WFCGenerator::BuildInstancedModels(const std::vector<int>& tiles, int width, int height, int depth,
+                                                         const std::vector<ModelData>& tileModels) const {
+    // 先统计每种瓦片的实例数量，只为出现过且有几何数据的瓦片生成模型
+    std::vector<size_t> instanceCounts(tileModels.size(), 0);
+    for (int tileIdx : tiles) {
+        if (tileIdx >= 0) instanceCounts[tileIdx]++;
+    }
+    std::vector<int> modelIndex(tileModels.size(), -1);
+    std::vector<ModelData> models;
+    for (size_t t = 0; t < tileModels.size(); ++t) {
+        if (instanceCounts[t] == 0 || tileModels[t].vertices.empty()) continue;
+        modelIndex[t] = static_cast<int>(models.size());
+        ModelData model;
+        model.uuid = "tile_" + std::to_string(t);
+        model.filepath = tileModels[t].filepath;
+        model.transform = glm::mat4(1.0f);
+        model.vertexShaderPath = "Shaders/instanced.vs";
+        model.fragmentShaderPath = "Shaders/default.fs";
+        model.vertices = tileModels[t].vertices;
+        model.normals = tileModels[t].normals;
+        model.normals.resize(model.vertices.size(), glm::vec3(0.0f, 1.0f, 0.0f));
+        model.indices = tileModels[t].indices;
+        model.instanceTransforms.reserve(instanceCounts[t]);
+        models.push_back(std::move(model));
+    }
 
-    std::mt19937 gen(std::random_device{}());
-    std::uniform_int_distribution<> dist(0, grid[y][x][z].possibleTiles.size() - 1);
-    int tileIdx = grid[y][x][z].possibleTiles[dist(gen)];
-    grid[y][x][z].possibleTiles = {tileIdx};
-    grid[y][x][z].collapsed = true;
+    // 每个单元格只产生一个平移变换，网格数据不随网格规模增长
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            for (int z = 0; z < depth; z++) {
+                int tileIdx = tiles[(static_cast<size_t>(y) * width + x) * depth + z];
+                if (tileIdx >= 0 && modelIndex[tileIdx] >= 0) {
+                    models[modelIndex[tileIdx]].instanceTransforms.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z)));
+                }
+            }
+        }
+    }
+    return models;
 }
 
-void WFCGenerator::Propagate(std::vector<std::vector<std::vector<Cell>>>& grid, int x, int y, int z, const std::vector<std::string>& tileSet, const nlohmann::json& adjacencyRules) {
-    std::vector<std::tuple<int, int, int>> stack = {{x, y, z}};
-    while (!stack.empty() && !cancelled_) {
-        auto [cx, cy, cz] = stack.back();
-        stack.pop_back();
-
-        std::vector<std::tuple<int, int, int>> directions = {
-            {cx + 1, cy, cz}, {cx - 1, cy, cz}, {cx, cy + 1, cz}, {cx, cy - 1, cz}, {cx, cy, cz + 1}, {cx, cy, cz - 1}
-        };
+ModelData WFCGenerator::BuildChunkMesh(const std::vector<int>& tiles, int width, int height, int depth, int x0, int z0,
+                                       int chunkWidth, int chunkDepth, const std::vector<ModelData>& tileModels) const {
+    ModelData chunk;
+    chunk.filepath = "";
+    chunk.transform = glm::mat4(1.0f);
+    chunk.vertexShaderPath = "Shaders/default.vs";
+    chunk.fragmentShaderPath = "Shaders/default.fs";
 
-        for (const auto& [nx, ny, nz] : directions) {
-            if (nx < 0 || nx >= grid[0].size() || ny < 0 || ny >= grid.size() || nz < 0 || nz >= grid[0][0].size() || grid[ny][nx][nz].collapsed) continue;
-
-            std::vector<int> newPossible;
-            for (int tileIdx : grid[ny][nx][nz].possibleTiles) {
-                bool valid = true;
-                for (int adjIdx : grid[cy][cx][cz].possibleTiles) {
-                    std::string tile = tileSet[tileIdx];
-                    std::string adjTile = tileSet[adjIdx];
-                    auto adjList = adjacencyRules.value(adjTile, nlohmann::json::array());
-                    if (std::find(adjList.begin(), adjList.end(), tile) == adjList.end()) {
-                        valid = false;
-                        break;
-                    }
+    // 先统计块内的顶点与索引总数，一次性分配输出
+    size_t totalVertices = 0, totalIndices = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = x0; x < x0 + chunkWidth; x++) {
+            for (int z = z0; z < z0 + chunkDepth; z++) {
+                int tileIdx = tiles[(static_cast<size_t>(y) * width + x) * depth + z];
+                if (tileIdx >= 0) {
+                    totalVertices += tileModels[tileIdx].vertices.size();
+                    totalIndices += tileModels[tileIdx].indices.size();
                 }
-                if (valid) newPossible.push_back(tileIdx);
-            }
-
-            if (newPossible.empty()) {
-                // 矛盾，需回溯（简化实现中忽略）
-                continue;
             }
+        }
+    }
+    chunk.vertices.reserve(totalVertices);
+    chunk.normals.reserve(totalVertices);
+    chunk.indices.reserve(totalIndices);
 
-            if (newPossible.size() != grid[ny][nx][nz].possibleTiles.size()) {
-                grid[ny][nx][nz].possibleTiles = newPossible;
-                if (newPossible.size() == 1) {
-                    grid[ny][nx][nz].collapsed = true;
+    // 瓦片只做平移，顶点直接加偏移，法线直接复制
+    for (int y = 0; y < height; y++) {
+        for (int x = x0; x < x0 + chunkWidth; x++) {
+            for (int z = z0; z < z0 + chunkDepth; z++) {
+                int tileIdx = tiles[(static_cast<size_t>(y) * width + x) * depth + z];
+                if (tileIdx < 0) continue;
+                const ModelData& tileData = tileModels[tileIdx];
+                glm::vec3 offset(x, y, z);
+                unsigned int baseIdx = static_cast<unsigned int>(chunk.vertices.size());
+                for (size_t v = 0; v < tileData.vertices.size(); ++v) {
+                    chunk.vertices.push_back(tileData.vertices[v] + offset);
+                    chunk.normals.push_back(v < tileData.normals.size() ? tileData.normals[v] : glm::vec3(0.0f, 1.0f, 0.0f));
+                }
+                for (unsigned int index : tileData.indices) {
+                    chunk.indices.push_back(baseIdx + index);
                 }
-                stack.emplace_back(nx, ny, nz);
             }
         }
     }
-}
\ No newline at end of file
+    return chunk;
+}
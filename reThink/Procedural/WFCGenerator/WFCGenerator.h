@@ -1,32 +1,46 @@
 ﻿#pragma once
 #include "IProceduralGenerator/IProceduralGenerator.h"
 #include "ModelLoader/ModelLoader.h"
+#include "WFCSolver.h"
+#include "WFCChunkedSolver.h"
 #include <vector>
-#include <atomic>
-#include <thread>
-#include <map>
 
 class WFCGenerator : public IProceduralGenerator {
 public:
-    WFCGenerator(std::shared_ptr<ModelLoader> modelLoader);
-    ~WFCGenerator() override;
+    WFCGenerator(std::shared_ptr<ModelLoader> modelLoader, std::shared_ptr<ThreadPool> threadPool);
 
-    void Generate(const nlohmann::json& params, std::shared_ptr<EventBus> eventBus) override;
-    void Cancel() override;
+    ModelData Generate(const nlohmann::json& params, ProceduralJobContext& context) override;
+    // 在线程池中并行加载瓦片模型，求解在加载完成后开始
+    std::vector<ThreadPool::TaskHandle> Prepare(const nlohmann::json& params, ProceduralJobContext& context) override;
     std::string GetName() const override { return "WFC"; }
+    std::string GetWorkUnitName() const override { return "cells"; }
+    // 瓦片模型文件
+    std::vector<std::string> GetInputFiles(const nlohmann::json& params) const override;
 
 private:
-    struct Cell {
-        std::vector<int> possibleTiles; // 可用的瓦片索引
-        bool collapsed = false;
+    /**
+     * @brief 网格求解与输出选项。
+     */
+    struct GridOptions {
+        uint32_t seed = 0;
+        size_t maxBacktracks = 1000;
+        int chunkSize = 0;       // 分块边长，0 表示按网格规模自动决定
+        bool instanced = false;  // 每种瓦片输出一个网格及其实例变换
+        bool voxelize = false;   // 每个非空单元格输出为立方体，剔除内部面并合并共面矩形
     };
 
-    void RunGeneration(const nlohmann::json& params, std::shared_ptr<EventBus> eventBus);
-    ModelData GenerateGrid(const std::vector<std::string>& tileSet, const nlohmann::json& adjacencyRules, int width, int height, int depth);
-    void Collapse(std::vector<std::vector<std::vector<Cell>>>& grid, int x, int y, int z, const std::vector<std::string>& tileSet, const nlohmann::json& adjacencyRules);
-    void Propagate(std::vector<std::vector<std::vector<Cell>>>& grid, int x, int y, int z, const std::vector<std::string>& tileSet, const nlohmann::json& adjacencyRules);
+    using TileLoads = ThreadPool::Task<std::vector<ModelData>>;
+
+    // 非空瓦片的模型文件，顺序与 tileSet 中的非空瓦片一致
+    static std::vector<std::string> GetMeshFiles(const std::vector<std::string>& tileSet);
+
+    bool GenerateGrid(const std::vector<std::string>& tileSet, const nlohmann::json& adjacencyRules, int width, int height, int depth,
+                      const GridOptions& options, const std::string& parentUUID, ProceduralJobContext& context);
+    std::vector<ModelData> BuildInstancedModels(const std::vector<int>& tiles, int width, int height, int depth,
+                                                const std::vector<ModelData>& tileModels) const;
+    ModelData BuildChunkMesh(const std::vector<int>& tiles, int width, int height, int depth, int x0, int z0,
+                             int chunkWidth, int chunkDepth, const std::vector<ModelData>& tileModels) const;
 
     std::shared_ptr<ModelLoader> modelLoader_;
-    std::atomic<bool> cancelled_;
-    std::thread generationThread_;
+    std::shared_ptr<ThreadPool> threadPool_;
 };
\ No newline at end of file
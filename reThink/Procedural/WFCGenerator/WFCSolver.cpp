@@ -0,0 +1,535 @@
+﻿#include "WFCSolver.h"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    inline uint32_t PopCount(uint64_t value) {
+#ifdef _MSC_VER
+        return static_cast<uint32_t>(__popcnt64(value));
+#else
+        return static_cast<uint32_t>(__builtin_popcountll(value));
+#endif
+    }
+
+    // 瓦片数量不超过该值（4 个字）时使用按字节查表的并集计算
+    constexpr size_t kMaxByteSupportWords = 4;
+
+    inline uint32_t LowestBit(uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    int OppositeDirection(int direction) {
+        return direction ^ 1; // PosX/NegX、PosY/NegY、PosZ/NegZ 成对相邻
+    }
+
+    int ParseDirection(const std::string& name) {
+        static const char* names[WFCSolver::DirectionCount] = {"+x", "-x", "+y", "-y", "+z", "-z"};
+        for (int d = 0; d < WFCSolver::DirectionCount; ++d) {
+            if (name == names[d]) return d;
+        }
+        throw std::invalid_argument("WFCSolver: Unknown adjacency direction " + name);
+    }
+}
+
+WFCSolver::WFCSolver(const std::vector<std::string>& tileSet, const nlohmann::json& adjacencyRules)
+    : tileCount_(tileSet.size()), words_((tileSet.size() + 63) / 64) {
+    if (tileSet.empty()) throw std::invalid_argument("WFCSolver: tileSet cannot be empty");
+
+    propagator_.assign(DirectionCount * tileCount_ * words_, 0);
+    support_.assign(words_, 0);
+
+    if (!adjacencyRules.is_object() || adjacencyRules.empty()) {
+        // 没有规则时不施加约束
+        for (int d = 0; d < DirectionCount; ++d) {
+            for (size_t t = 0; t < tileCount_; ++t) {
+                uint64_t* mask = Propagator(d, t);
+                for (size_t b = 0; b < tileCount_; ++b) {
+                    mask[b / 64] |= uint64_t(1) << (b % 64);
+                }
+            }
+        }
+        BuildFullSupport();
+        BuildByteSupport();
+        return;
+    }
+
+    std::unordered_map<std::string, size_t> tileIndices;
+    for (size_t i = 0; i < tileSet.size(); ++i) {
+        tileIndices.emplace(tileSet[i], i);
+    }
+
+    // 记录 a 在 direction 方向允许 b，同时补全 b 在反方向允许 a
+    auto allow = [this](int direction, size_t a, size_t b) {
+        Propagator(direction, a)[b / 64] |= uint64_t(1) << (b % 64);
+        Propagator(OppositeDirection(direction), b)[a / 64] |= uint64_t(1) << (a % 64);
+    };
+    auto allowList = [&](int direction, size_t a, const nlohmann::json& list) {
+        for (const auto& name : list) {
+            auto it = tileIndices.find(name.get<std::string>());
+            if (it != tileIndices.end()) {
+                allow(direction, a, it->second);
+            }
+        }
+    };
+
+    for (auto& [tileName, rule] : adjacencyRules.items()) {
+        auto it = tileIndices.find(tileName);
+        if (it == tileIndices.end()) continue; // 忽略不在瓦片集中的规则
+        if (rule.is_array()) {
+            for (int d = 0; d < DirectionCount; ++d) {
+                allowList(d, it->second, rule);
+            }
+        } else if (rule.is_object()) {
+            for (auto& [directionName, list] : rule.items()) {
+                allowList(ParseDirection(directionName), it->second, list);
+            }
+        }
+    }
+    BuildFullSupport();
+    BuildByteSupport();
+}
+
+void WFCSolver::BuildFullSupport() {
+    fullSupport_.assign(DirectionCount * words_, 0);
+    for (int d = 0; d < DirectionCount; ++d) {
+        for (size_t t = 0; t < tileCount_; ++t) {
+            const uint64_t* mask = Propagator(d, t);
+            for (size_t k = 0; k < words_; ++k) {
+                fullSupport_[d * words_ + k] |= mask[k];
+            }
+        }
+    }
+}
+
+void WFCSolver::BuildByteSupport() {
+    byteSupport_.clear();
+    if (words_ > kMaxByteSupportWords) {
+        return;
+    }
+    const size_t bytePositions = words_ * 8;
+    byteSupport_.assign(DirectionCount * bytePositions * 256 * words_, 0);
+    for (int d = 0; d < DirectionCount; ++d) {
+        for (size_t position = 0; position < bytePositions; ++position) {
+            uint64_t* table = &byteSupport_[(d * bytePositions + position) * 256 * words_];
+            // 字节值 v 的并集 = 去掉最低位后的并集 | 最低位对应瓦片的掩码
+            for (size_t value = 1; value < 256; ++value) {
+                size_t tile = position * 8 + LowestBit(value);
+                const uint64_t* previous = &table[(value & (value - 1)) * words_];
+                uint64_t* entry = &table[value * words_];
+                for (size_t k = 0; k < words_; ++k) {
+                    entry[k] = previous[k] | (tile < tileCount_ ? Propagator(d, tile)[k] : 0);
+                }
+            }
+        }
+    }
+}
+
+void WFCSolver::ComputeSupport(const uint64_t* wave, int direction) {
+    std::fill(support_.begin(), support_.end(), 0);
+    if (!byteSupport_.empty()) {
+        const size_t bytePositions = words_ * 8;
+        const uint64_t* tables = &byteSupport_[direction * bytePositions * 256 * words_];
+        for (size_t w = 0; w < words_; ++w) {
+            uint64_t bits = wave[w];
+            for (size_t b = 0; bits; ++b, bits >>= 8) {
+                size_t value = bits & 0xFF;
+                if (!value) continue;
+                const uint64_t* entry = &tables[((w * 8 + b) * 256 + value) * words_];
+                for (size_t k = 0; k < words_; ++k) {
+                    support_[k] |= entry[k];
+                }
+            }
+        }
+        return;
+    }
+
+    for (size_t w = 0; w < words_; ++w) {
+        uint64_t bits = wave[w];
+        while (bits) {
+            size_t tile = w * 64 + LowestBit(bits);
+            bits &= bits - 1;
+            const uint64_t* mask = Propagator(direction, tile);
+            for (size_t k = 0; k < words_; ++k) {
+                support_[k] |= mask[k];
+            }
+        }
+    }
+}
+
+void WFCSolver::Reset(int width, int height, int depth) {
+    if (width <= 0 || height <= 0 || depth <= 0) {
+        throw std::invalid_argument("WFCSolver: Grid dimensions must be positive");
+    }
+    width_ = width;
+    height_ = height;
+    depth_ = depth;
+
+    size_t cellCount = static_cast<size_t>(width) * height * depth;
+    std::vector<uint64_t> full(words_, ~uint64_t(0));
+    if (tileCount_ % 64 != 0) {
+        full.back() = (uint64_t(1) << (tileCount_ % 64)) - 1;
+    }
+    wave_.resize(cellCount * words_);
+    for (size_t cell = 0; cell < cellCount; ++cell) {
+        std::copy(full.begin(), full.end(), CellWave(cell));
+    }
+    counts_.assign(cellCount, static_cast<uint32_t>(tileCount_));
+    queued_.assign(cellCount, 0);
+    collapsedCount_ = tileCount_ == 1 ? cellCount : 0;
+    stack_.clear();
+}
+
+bool WFCSolver::Neighbor(size_t cell, int x, int y, int z, int direction, size_t& neighbor) const {
+    switch (direction) {
+        case PosX: if (x + 1 >= width_) return false; neighbor = cell + depth_; return true;
+        case NegX: if (x == 0) return false; neighbor = cell - depth_; return true;
+        case PosY: if (y + 1 >= height_) return false; neighbor = cell + static_cast<size_t>(depth_) * width_; return true;
+        case NegY: if (y == 0) return false; neighbor = cell - static_cast<size_t>(depth_) * width_; return true;
+        case PosZ: if (z + 1 >= depth_) return false; neighbor = cell + 1; return true;
+        case NegZ: if (z == 0) return false; neighbor = cell - 1; return true;
+        default: return false;
+    }
+}
+
+void WFCSolver::SetCount(size_t cell, uint32_t count) {
+    if (counts_[cell] != 1 && count == 1) collapsedCount_++;
+    if (counts_[cell] == 1 && count != 1) collapsedCount_--;
+    counts_[cell] = count;
+    if (heapActive_) {
+        HeapUpdate(cell);
+    }
+}
+
+void WFCSolver::RecordCell(size_t cell) {
+    // 第一个决策之前的修改永远不会被撤销，无需记录
+    if (decisions_.empty()) {
+        return;
+    }
+    trail_.push_back({cell, counts_[cell]});
+    const uint64_t* wave = CellWave(cell);
+    trailWaves_.insert(trailWaves_.end(), wave, wave + words_);
+}
+
+void WFCSolver::UndoTo(size_t mark) {
+    while (trailBase_ + trail_.size() > mark) {
+        TrailEntry entry = trail_.back();
+        trail_.pop_back();
+        uint64_t* wave = CellWave(entry.cell);
+        for (size_t k = words_; k-- > 0;) {
+            wave[k] = trailWaves_.back();
+            trailWaves_.pop_back();
+        }
+        SetCount(entry.cell, entry.count);
+    }
+}
+
+bool WFCSolver::Ban(size_t cell, int tile) {
+    uint64_t* wave = CellWave(cell);
+    uint64_t bit = uint64_t(1) << (tile % 64);
+    if (!(wave[tile / 64] & bit)) {
+        return true;
+    }
+    RecordCell(cell);
+    wave[tile / 64] &= ~bit;
+    SetCount(cell, counts_[cell] - 1);
+    if (counts_[cell] == 0) {
+        return false;
+    }
+    if (!queued_[cell]) {
+        queued_[cell] = 1;
+        stack_.push_back(cell);
+    }
+    return Propagate();
+}
+
+bool WFCSolver::Backtrack() {
+    // 撤销最近的决策并排除其选择；排除后仍矛盾则继续向前回溯
+    while (!decisions_.empty()) {
+        if (backtracks_ >= maxBacktracks_) {
+            return false;
+        }
+        Decision decision = decisions_.back();
+        decisions_.pop_back();
+        backtracks_++;
+        UndoTo(decision.trailMark);
+        if (Ban(decision.cell, decision.tile)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WFCSolver::SetBacktrackLimits(size_t maxDepth, size_t maxBacktracks) {
+    maxBacktrackDepth_ = maxDepth;
+    maxBacktracks_ = maxBacktracks;
+}
+
+bool WFCSolver::Collapse(int x, int y, int z, int tile) {
+    size_t cell = CellIndex(x, y, z);
+    uint64_t* wave = CellWave(cell);
+    if (!(wave[tile / 64] & (uint64_t(1) << (tile % 64)))) {
+        return false; // 该瓦片已被排除
+    }
+    RecordCell(cell);
+    std::fill(wave, wave + words_, 0);
+    wave[tile / 64] = uint64_t(1) << (tile % 64);
+    SetCount(cell, 1);
+    if (!queued_[cell]) {
+        queued_[cell] = 1;
+        stack_.push_back(cell);
+    }
+    return Propagate();
+}
+
+bool WFCSolver::Restrict(int x, int y, int z, int direction, int neighborTile) {
+    size_t cell = CellIndex(x, y, z);
+    uint64_t* wave = CellWave(cell);
+    // 单元格位于邻居的反方向，其允许集合即邻居在反方向上的邻接掩码
+    const uint64_t* allowed = Propagator(OppositeDirection(direction), neighborTile);
+    bool changed = false;
+    for (size_t k = 0; k < words_; ++k) {
+        changed |= (wave[k] & ~allowed[k]) != 0;
+    }
+    if (!changed) {
+        return counts_[cell] > 0;
+    }
+
+    RecordCell(cell);
+    uint32_t count = 0;
+    for (size_t k = 0; k < words_; ++k) {
+        wave[k] &= allowed[k];
+        count += PopCount(wave[k]);
+    }
+    SetCount(cell, count);
+    if (count == 0) {
+        return false;
+    }
+    if (!queued_[cell]) {
+        queued_[cell] = 1;
+        stack_.push_back(cell);
+    }
+    return true;
+}
+
+bool WFCSolver::Propagate() {
+    while (!stack_.empty()) {
+        size_t cell = stack_.back();
+        stack_.pop_back();
+        queued_[cell] = 0;
+        const uint64_t* wave = CellWave(cell);
+        int z = static_cast<int>(cell % depth_);
+        int x = static_cast<int>((cell / depth_) % width_);
+        int y = static_cast<int>(cell / (static_cast<size_t>(depth_) * width_));
+
+        for (int d = 0; d < DirectionCount; ++d) {
+            size_t neighbor;
+            if (!Neighbor(cell, x, y, z, d, neighbor)) continue;
+
+            // 邻居允许的瓦片 = 当前单元格所有候选瓦片在该方向上允许集合的并集；
+            // 单元格仍可为任意瓦片时直接使用预先计算的并集
+            const uint64_t* support = &fullSupport_[d * words_];
+            if (counts_[cell] != tileCount_) {
+                ComputeSupport(wave, d);
+                support = support_.data();
+            }
+
+            uint64_t* neighborWave = CellWave(neighbor);
+            bool changed = false;
+            for (size_t k = 0; k < words_; ++k) {
+                changed |= (neighborWave[k] & ~support[k]) != 0;
+            }
+            if (!changed) continue;
+
+            RecordCell(neighbor);
+            uint32_t count = 0;
+            for (size_t k = 0; k < words_; ++k) {
+                neighborWave[k] &= support[k];
+                count += PopCount(neighborWave[k]);
+            }
+
+            SetCount(neighbor, count);
+            if (count == 0) {
+                for (size_t pending : stack_) queued_[pending] = 0;
+                stack_.clear();
+                return false; // 矛盾：邻居已无可选瓦片
+            }
+            if (!queued_[neighbor]) {
+                queued_[neighbor] = 1;
+                stack_.push_back(neighbor);
+            }
+        }
+    }
+    return true;
+}
+
+int WFCSolver::PickTile(size_t cell, std::mt19937& rng) const {
+    // 在候选瓦片中等概率选择一个
+    uint32_t pick = std::uniform_int_distribution<uint32_t>(0, counts_[cell] - 1)(rng);
+    const uint64_t* wave = CellWave(cell);
+    for (size_t w = 0; w < words_; ++w) {
+        uint32_t bitsInWord = PopCount(wave[w]);
+        if (pick >= bitsInWord) {
+            pick -= bitsInWord;
+            continue;
+        }
+        uint64_t bits = wave[w];
+        for (uint32_t i = 0; i < pick; ++i) bits &= bits - 1;
+        return static_cast<int>(w * 64 + LowestBit(bits));
+    }
+    return -1;
+}
+
+bool WFCSolver::Solve(uint32_t seed, const std::atomic<bool>* cancelled) {
+    std::mt19937 rng(seed);
+    size_t cellCount = counts_.size();
+    for (size_t cell = 0; cell < cellCount; ++cell) {
+        if (counts_[cell] == 0) return false;
+    }
+
+    backtracks_ = 0;
+    decisions_.clear();
+    trail_.clear();
+    trailWaves_.clear();
+    trailBase_ = 0;
+    tieBreak_.resize(cellCount);
+    for (auto& tie : tieBreak_) {
+        tie = rng();
+    }
+    HeapBuild();
+    heapActive_ = true;
+
+    bool solved = false;
+    size_t observations = 0;
+    while (true) {
+        if (cancelled && *cancelled) break;
+        if (heap_.empty()) {
+            solved = true;
+            break;
+        }
+        if (progressCallback_ && ++observations % progressInterval_ == 0) {
+            progressCallback_(collapsedCount_);
+        }
+
+        // 观察：取候选数最少的单元格并随机选择瓦片
+        size_t cell = heap_.front();
+        int tile = PickTile(cell, rng);
+        if (maxBacktrackDepth_ > 0) {
+            decisions_.push_back({trailBase_ + trail_.size(), cell, tile});
+            if (decisions_.size() > maxBacktrackDepth_) {
+                // 超出回溯深度的决策不再可撤销，丢弃其轨迹
+                decisions_.pop_front();
+                while (trailBase_ < decisions_.front().trailMark) {
+                    trail_.pop_front();
+                    trailWaves_.erase(trailWaves_.begin(), trailWaves_.begin() + words_);
+                    trailBase_++;
+                }
+            }
+        }
+
+        size_t x = (cell / depth_) % width_;
+        size_t y = cell / (static_cast<size_t>(depth_) * width_);
+        if (!Collapse(static_cast<int>(x), static_cast<int>(y), static_cast<int>(cell % depth_), tile) && !Backtrack()) {
+            break;
+        }
+    }
+
+    heapActive_ = false;
+    heap_.clear();
+    decisions_.clear();
+    trail_.clear();
+    trailWaves_.clear();
+    return solved;
+}
+
+bool WFCSolver::HeapLess(size_t a, size_t b) const {
+    if (counts_[a] != counts_[b]) return counts_[a] < counts_[b];
+    if (tieBreak_[a] != tieBreak_[b]) return tieBreak_[a] < tieBreak_[b];
+    return a < b;
+}
+
+void WFCSolver::HeapSiftUp(size_t position) {
+    while (position > 0) {
+        size_t parent = (position - 1) / 2;
+        if (!HeapLess(heap_[position], heap_[parent])) break;
+        std::swap(heap_[position], heap_[parent]);
+        heapPosition_[heap_[position]] = position;
+        heapPosition_[heap_[parent]] = parent;
+        position = parent;
+    }
+}
+
+void WFCSolver::HeapSiftDown(size_t position) {
+    while (true) {
+        size_t smallest = position;
+        size_t left = position * 2 + 1, right = left + 1;
+        if (left < heap_.size() && HeapLess(heap_[left], heap_[smallest])) smallest = left;
+        if (right < heap_.size() && HeapLess(heap_[right], heap_[smallest])) smallest = right;
+        if (smallest == position) break;
+        std::swap(heap_[position], heap_[smallest]);
+        heapPosition_[heap_[position]] = position;
+        heapPosition_[heap_[smallest]] = smallest;
+        position = smallest;
+    }
+}
+
+void WFCSolver::HeapRemove(size_t cell) {
+    size_t position = heapPosition_[cell];
+    size_t last = heap_.back();
+    heap_.pop_back();
+    heapPosition_[cell] = kNotInHeap;
+    if (last == cell) return;
+    heap_[position] = last;
+    heapPosition_[last] = position;
+    HeapSiftUp(position);
+    HeapSiftDown(heapPosition_[last]);
+}
+
+void WFCSolver::HeapUpdate(size_t cell) {
+    size_t position = heapPosition_[cell];
+    if (counts_[cell] <= 1) {
+        if (position != kNotInHeap) HeapRemove(cell);
+        return;
+    }
+    if (position == kNotInHeap) {
+        heap_.push_back(cell);
+        heapPosition_[cell] = heap_.size() - 1;
+        HeapSiftUp(heap_.size() - 1);
+    } else {
+        HeapSiftUp(position);
+        HeapSiftDown(heapPosition_[cell]);
+    }
+}
+
+void WFCSolver::HeapBuild() {
+    heap_.clear();
+    heapPosition_.assign(counts_.size(), kNotInHeap);
+    for (size_t cell = 0; cell < counts_.size(); ++cell) {
+        if (counts_[cell] > 1) {
+            heapPosition_[cell] = heap_.size();
+            heap_.push_back(cell);
+        }
+    }
+    for (size_t i = heap_.size() / 2; i-- > 0;) {
+        HeapSiftDown(i);
+    }
+}
+
+int WFCSolver::GetTile(int x, int y, int z) const {
+    size_t cell = CellIndex(x, y, z);
+    if (counts_[cell] != 1) return -1;
+    const uint64_t* wave = CellWave(cell);
+    for (size_t w = 0; w < words_; ++w) {
+        if (wave[w]) return static_cast<int>(w * 64 + LowestBit(wave[w]));
+    }
+    return -1;
+}
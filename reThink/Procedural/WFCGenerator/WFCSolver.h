@@ -0,0 +1,175 @@
+﻿#pragma once
+#include <vector>
+#include <string>
+#include <random>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief 基于位集的波函数坍缩求解器。
+ *
+ * 邻接规则在构造时一次性编译为按方向划分的位掩码表：propagator[d][t] 表示单元格为瓦片 t 时，
+ * 其 d 方向邻居允许出现的瓦片集合。波（每个单元格的候选瓦片集合）存储为连续的 64 位字数组，
+ * 传播时对候选瓦片的掩码按字求并，再与邻居按字求交。瓦片不超过 256 个时，
+ * 掩码的并集按波的每个字节查预计算表得到，开销与候选瓦片数量无关。
+ *
+ * 邻接规则支持两种形式：
+ * - 数组形式 "tileA": ["tileB", ...]：对所有方向生效，并自动对称（B 也允许与 A 相邻）。
+ * - 对象形式 "tileA": { "+x": [...], "-x": [...], "+y": [...], "-y": [...], "+z": [...], "-z": [...] }：
+ *   按方向指定，同样自动补全反方向的对称关系。
+ * 规则为空时所有瓦片两两可相邻。
+ *
+ * Solve 采用完整的观察/传播循环：每次从最小熵堆中取出候选数最少的单元格（同候选数时按
+ * 由种子决定的随机次序），随机选择瓦片后传播。出现矛盾时沿变更轨迹撤销最近的决策并排除
+ * 该瓦片，回溯深度与总次数均有上限。相同的种子与参数总能得到相同的结果。
+ */
+class WFCSolver {
+public:
+    enum Direction { PosX = 0, NegX, PosY, NegY, PosZ, NegZ, DirectionCount };
+
+    /**
+     * @brief 编译瓦片集与邻接规则。
+     * @param tileSet 瓦片名称列表，下标即瓦片索引。
+     * @param adjacencyRules 邻接规则（JSON 格式）。
+     */
+    WFCSolver(const std::vector<std::string>& tileSet, const nlohmann::json& adjacencyRules);
+
+    /**
+     * @brief 重置网格，所有单元格恢复为全部瓦片可选。
+     */
+    void Reset(int width, int height, int depth);
+
+    /**
+     * @brief 将单元格坍缩为指定瓦片并传播约束。
+     * @return 传播过程中出现矛盾时返回 false。
+     */
+    bool Collapse(int x, int y, int z, int tile);
+
+    /**
+     * @brief 按网格外已确定的邻居约束单元格：只保留允许与该邻居相邻的瓦片，暂不传播。
+     * @param direction 从单元格指向邻居的方向。
+     * @param neighborTile 邻居的瓦片索引。
+     * @return 单元格已无可选瓦片时返回 false。
+     */
+    bool Restrict(int x, int y, int z, int direction, int neighborTile);
+
+    /**
+     * @brief 传播此前 Restrict 施加的约束。
+     * @return 出现矛盾时返回 false。
+     */
+    bool ApplyConstraints() { return Propagate(); }
+
+    /**
+     * @brief 反复观察最小熵单元格并传播，直到网格完全确定。
+     * @param seed 随机种子，决定同熵单元格的次序与瓦片选择。
+     * @param cancelled 可选的取消标志。
+     * @return 求解成功返回 true；回溯次数耗尽、无法回溯或被取消时返回 false。
+     */
+    bool Solve(uint32_t seed, const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * @brief 设置回溯上限。
+     * @param maxDepth 可撤销的最近决策数量，更早的决策视为固定，用于限制轨迹内存。
+     * @param maxBacktracks 单次 Solve 允许的回溯总次数。
+     */
+    void SetBacktrackLimits(size_t maxDepth, size_t maxBacktracks);
+
+    /**
+     * @brief 设置进度回调，Solve 每完成 interval 次观察调用一次，参数为当前已确定的单元格数量。
+     */
+    void SetProgressCallback(std::function<void(size_t collapsedCount)> callback, size_t interval = 4096) {
+        progressCallback_ = std::move(callback);
+        progressInterval_ = interval > 0 ? interval : 1;
+    }
+
+    size_t GetBacktrackCount() const { return backtracks_; }
+
+    /**
+     * @brief 获取单元格确定的瓦片索引，尚未确定或矛盾时返回 -1。
+     */
+    int GetTile(int x, int y, int z) const;
+
+    /**
+     * @brief 获取单元格当前的候选瓦片数量。
+     */
+    int GetOptionCount(int x, int y, int z) const { return counts_[CellIndex(x, y, z)]; }
+
+    int GetWidth() const { return width_; }
+    int GetHeight() const { return height_; }
+    int GetDepth() const { return depth_; }
+    size_t GetTileCount() const { return tileCount_; }
+    size_t GetCollapsedCount() const { return collapsedCount_; }
+
+private:
+    size_t CellIndex(int x, int y, int z) const {
+        return (static_cast<size_t>(y) * width_ + x) * depth_ + z;
+    }
+    bool Neighbor(size_t cell, int x, int y, int z, int direction, size_t& neighbor) const;
+    bool Propagate();
+    void BuildFullSupport();
+    void BuildByteSupport();
+    void ComputeSupport(const uint64_t* wave, int direction);
+    void SetCount(size_t cell, uint32_t count);
+    void RecordCell(size_t cell);
+    void UndoTo(size_t mark);
+    bool Ban(size_t cell, int tile);
+    bool Backtrack();
+    int PickTile(size_t cell, std::mt19937& rng) const;
+
+    // 最小熵索引堆：键为 (候选数, 随机次序)，只包含候选数大于 1 的单元格
+    bool HeapLess(size_t a, size_t b) const;
+    void HeapUpdate(size_t cell);
+    void HeapSiftUp(size_t position);
+    void HeapSiftDown(size_t position);
+    void HeapRemove(size_t cell);
+    void HeapBuild();
+    uint64_t* CellWave(size_t cell) { return &wave_[cell * words_]; }
+    const uint64_t* CellWave(size_t cell) const { return &wave_[cell * words_]; }
+    uint64_t* Propagator(int direction, size_t tile) { return &propagator_[(direction * tileCount_ + tile) * words_]; }
+    const uint64_t* Propagator(int direction, size_t tile) const { return &propagator_[(direction * tileCount_ + tile) * words_]; }
+
+    size_t tileCount_;
+    size_t words_;                       // 每个单元格占用的 64 位字数量
+    std::vector<uint64_t> propagator_;   // [方向][瓦片][字] 的邻接掩码
+    std::vector<uint64_t> fullSupport_;  // [方向][字]：单元格仍可为任意瓦片时邻居允许的集合
+    std::vector<uint64_t> byteSupport_;  // [方向][波的字节位置][字节值][字]：该字节内候选瓦片掩码的并集
+    int width_ = 0, height_ = 0, depth_ = 0;
+    std::vector<uint64_t> wave_;         // [单元格][字] 的候选瓦片位集
+    std::vector<uint32_t> counts_;       // 每个单元格的候选瓦片数量
+    size_t collapsedCount_ = 0;          // 候选数量为 1 的单元格数量
+    std::vector<size_t> stack_;          // 待传播的单元格
+    std::vector<uint8_t> queued_;        // 单元格是否已在 stack_ 中
+    std::vector<uint64_t> support_;      // 传播时复用的掩码缓冲
+
+    static constexpr size_t kNotInHeap = static_cast<size_t>(-1);
+    std::vector<size_t> heap_;           // 堆中的单元格
+    std::vector<size_t> heapPosition_;   // 单元格在堆中的位置，不在堆中为 kNotInHeap
+    std::vector<uint32_t> tieBreak_;     // 同候选数时的随机次序
+    bool heapActive_ = false;            // 仅在 Solve 期间维护堆
+
+    /**
+     * @brief 决策记录：坍缩的单元格、选择的瓦片与决策前的轨迹位置。
+     */
+    struct Decision {
+        size_t trailMark;
+        size_t cell;
+        int tile;
+    };
+    struct TrailEntry {
+        size_t cell;
+        uint32_t count;
+    };
+    std::deque<Decision> decisions_;
+    std::deque<TrailEntry> trail_;       // 决策后被修改单元格的旧状态
+    std::deque<uint64_t> trailWaves_;    // 与 trail_ 对应的旧波数据，每项 words_ 个字
+    size_t trailBase_ = 0;               // 已丢弃的轨迹项数量，使轨迹位置保持单调
+    size_t maxBacktrackDepth_ = 64;
+    size_t maxBacktracks_ = 1000;
+    size_t backtracks_ = 0;
+
+    std::function<void(size_t)> progressCallback_;
+    size_t progressInterval_ = 4096;
+};
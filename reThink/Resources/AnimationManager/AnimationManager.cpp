@@ -79,11 +79,18 @@ void AnimationManager::SetupEventSubscriptions() {
     // 新增：监听 ControlPanel 的变换请求，动画播放时忽略
     eventBus_->Subscribe<Events::ModelTransformedEvent>(
         [this](const Events::ModelTransformedEvent& event) {
-            if (isPlaying_) {
-                // 动画播放时，AnimationManager 是权威源，恢复关键帧变换
-                glm::mat4 correctTransform = GetModelTransformAtTime(currentTime_);
-                eventBus_->Publish(Events::ModelTransformedEvent{event.modelUUID, correctTransform});
+            if (!isPlaying_) return;
+            // 自己入队的纠正事件分发回来时不再纠正，否则播放期间每帧都会再入队一次
+            auto pending = pendingCorrections_.find(event.modelUUID);
+            if (pending != pendingCorrections_.end() && pending->second == event.transform) {
+                pendingCorrections_.erase(pending);
+                return;
             }
+            // 动画播放时，AnimationManager 是权威源，恢复关键帧变换
+            glm::mat4 correctTransform = GetModelTransformAtTime(currentTime_);
+            if (event.transform == correctTransform) return;
+            pendingCorrections_[event.modelUUID] = correctTransform;
+            eventBus_->Enqueue(Events::ModelTransformedEvent{event.modelUUID, correctTransform});
         });
 }
 
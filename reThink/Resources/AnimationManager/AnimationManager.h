@@ -84,6 +84,7 @@ private:
     InterpolationMethod interpMethod_ = InterpolationMethod::Linear; // 默认插值方法
     bool isPlaying_ = false;                         // 是否正在播放
     float currentTime_ = 0.0f;                       // 当前动画时间（秒）
+    std::map<std::string, glm::mat4> pendingCorrections_; // 已入队、尚未分发的纠正变换，按模型 UUID
     double startTime_ = 0.0;                         // 动画开始时间戳
 };
 
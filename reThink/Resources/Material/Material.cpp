@@ -14,30 +14,43 @@ Material::Material(std::shared_ptr<EventBus> eventBus, std::shared_ptr<MaterialM
     eventBus_->Publish(MaterialUpdatedEvent{uuid_, diffuseColor_, specularColor_, shininess_, textureUUID_});
 }
 
+Material::~Material() {
+    eventBus_->Unsubscribe(std::type_index(typeid(MaterialUpdatedEvent)), updatedSubId_);
+}
+
 void Material::SetDiffuseColor(const glm::vec3& color) {
+    if (diffuseColor_ == color) return;
     diffuseColor_ = color;
-    eventBus_->Publish(MaterialUpdatedEvent{uuid_, diffuseColor_, specularColor_, shininess_, textureUUID_});
+    NotifyUpdated();
 }
 
 void Material::SetSpecularColor(const glm::vec3& color) {
+    if (specularColor_ == color) return;
     specularColor_ = color;
-    eventBus_->Publish(MaterialUpdatedEvent{uuid_, diffuseColor_, specularColor_, shininess_, textureUUID_});
+    NotifyUpdated();
 }
 
 void Material::SetShininess(float shininess) {
+    if (shininess_ == shininess) return;
     shininess_ = shininess;
-    eventBus_->Publish(MaterialUpdatedEvent{uuid_, diffuseColor_, specularColor_, shininess_, textureUUID_});
+    NotifyUpdated();
 }
 
 void Material::SetTextureUUID(const std::string& textureUUID) {
+    if (textureUUID_ == textureUUID) return;
     textureUUID_ = textureUUID;
-    eventBus_->Publish(MaterialUpdatedEvent{uuid_, diffuseColor_, specularColor_, shininess_, textureUUID_});
+    NotifyUpdated();
 }
 
 void Material::BindShader(const std::string& vertexPath, const std::string& fragmentPath) {
     vertexShaderPath_ = vertexPath;
     fragmentShaderPath_ = fragmentPath;
-    eventBus_->Publish(MaterialUpdatedEvent{uuid_, diffuseColor_, specularColor_, shininess_, textureUUID_});
+    NotifyUpdated();
+}
+
+void Material::NotifyUpdated() {
+    // 排队分发：同一帧内对该材质的多次修改合并为一次 MaterialUpdatedEvent
+    eventBus_->Enqueue(MaterialUpdatedEvent{uuid_, diffuseColor_, specularColor_, shininess_, textureUUID_});
 }
 
 void Material::Apply() const {
@@ -50,13 +63,13 @@ void Material::Apply() const {
 }
 
 void Material::SubscribeToEvents() {
-    eventBus_->Subscribe<MaterialUpdatedEvent>([this](const MaterialUpdatedEvent& event) {
+    // 只订阅本材质 UUID 的更新，避免每次材质变化都通知所有材质实例
+    updatedSubId_ = eventBus_->SubscribeKeyed<MaterialUpdatedEvent>(uuid_, [this](const MaterialUpdatedEvent& event) {
         OnMaterialUpdated(event);
     });
 }
 
 void Material::OnMaterialUpdated(const MaterialUpdatedEvent& event) {
-    if (event.materialUUID != uuid_) return;
     diffuseColor_ = event.diffuseColor;
     specularColor_ = event.specularColor;
     shininess_ = event.shininess;
@@ -10,6 +10,7 @@ class MaterialManager; // 前向声明
 class Material {
 public:
     Material(std::shared_ptr<EventBus> eventBus, std::shared_ptr<MaterialManager> materialManager, const std::string& uuid);
+    ~Material();
     std::string GetUUID() const { return uuid_; }
 
     void SetDiffuseColor(const glm::vec3& color);
@@ -20,6 +21,9 @@ public:
     float GetShininess() const { return shininess_; }
     void SetTextureUUID(const std::string& textureUUID);
     std::string GetTextureUUID() const { return textureUUID_; }
+    // 纹理源文件路径；无界面模式下不创建纹理，只通过它保留材质引用的贴图
+    void SetTexturePath(const std::string& texturePath) { texturePath_ = texturePath; }
+    std::string GetTexturePath() const { return texturePath_; }
     void BindShader(const std::string& vertexPath, const std::string& fragmentPath);
     std::string GetVertexShaderPath() const { return vertexShaderPath_; }
     std::string GetFragmentShaderPath() const { return fragmentShaderPath_; }
@@ -27,15 +31,18 @@ public:
 
 private:
     void SubscribeToEvents();
+    void NotifyUpdated();
     void OnMaterialUpdated(const MyRenderer::Events::MaterialUpdatedEvent& event);
 
     std::shared_ptr<EventBus> eventBus_;
     std::shared_ptr<MaterialManager> materialManager_; // 新增依赖
     std::string uuid_;
+    EventBus::SubscriberId updatedSubId_ = 0;
     glm::vec3 diffuseColor_ = glm::vec3(1.0f);
     glm::vec3 specularColor_ = glm::vec3(1.0f);
     float shininess_ = 32.0f;
     std::string textureUUID_;
+    std::string texturePath_;
     std::string vertexShaderPath_;
     std::string fragmentShaderPath_;
 };
@@ -12,10 +12,16 @@ MaterialManager::MaterialManager(std::shared_ptr<EventBus> eventBus, std::shared
     SubscribeToEvents();
 }
 
+MaterialManager::MaterialManager(std::shared_ptr<EventBus> eventBus)
+    : eventBus_(std::move(eventBus)) {
+    if (!eventBus_) throw std::invalid_argument("MaterialManager: EventBus cannot be null");
+    SubscribeToEvents();
+}
+
 MaterialManager::~MaterialManager() {
     std::lock_guard<std::mutex> lock(mutex_);
     for (auto& [uuid, material] : materials_) {
-        if (!material->GetTextureUUID().empty()) {
+        if (textureManager_ && !material->GetTextureUUID().empty()) {
             textureManager_->Release(material->GetTextureUUID());
         }
     }
@@ -109,7 +115,7 @@ void MaterialManager::DeleteMaterial(const std::string& materialUUID) {
         };
         eventBus_->Publish(MyRenderer::Events::PushUndoOperationEvent{op});
         // 释放纹理引用
-        if (!material->GetTextureUUID().empty()) {
+        if (textureManager_ && !material->GetTextureUUID().empty()) {
             textureManager_->Release(material->GetTextureUUID());
         }
         eventBus_->Publish(MyRenderer::Events::MaterialDeletedEvent{materialUUID});
@@ -143,7 +149,7 @@ void MaterialManager::UpdateMaterial(const std::string& materialUUID, const Mate
             material->GetFragmentShaderPath()
         };
         // 更新纹理引用计数
-        if (oldData.textureUUID != data.textureUUID) {
+        if (textureManager_ && oldData.textureUUID != data.textureUUID) {
             if (!oldData.textureUUID.empty()) {
                 textureManager_->Release(oldData.textureUUID);
             }
@@ -180,7 +186,8 @@ std::string MaterialManager::LoadMaterial(const glm::vec3& diffuse, const glm::v
     material->SetDiffuseColor(diffuse);
     material->SetSpecularColor(specular);
     material->SetShininess(shininess);
-    if (!texturePath.empty()) {
+    material->SetTexturePath(texturePath);
+    if (!texturePath.empty() && textureManager_) {
         std::string textureUUID = textureManager_->LoadTexture(texturePath);
         material->SetTextureUUID(textureUUID);
     }
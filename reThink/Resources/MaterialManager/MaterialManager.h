@@ -15,8 +15,12 @@ class TextureManager;
 class MaterialManager : public std::enable_shared_from_this<MaterialManager> { // 继承 enable_shared_from_this
 public:
     MaterialManager(std::shared_ptr<EventBus> eventBus, std::shared_ptr<TextureManager> textureManager);
+    // 无界面模式：没有 OpenGL 上下文时使用，材质只记录纹理路径，不创建 GPU 纹理
+    explicit MaterialManager(std::shared_ptr<EventBus> eventBus);
     ~MaterialManager();
 
+    bool IsHeadless() const { return !textureManager_; }
+
     std::string CreateMaterial();
     bool LoadMaterial(const nlohmann::json& materialData, std::string& errorMsg);
     nlohmann::json SaveMaterials() const;
@@ -35,7 +39,7 @@ private:
     void OnTextureLoaded(const MyRenderer::Events::TextureLoadedEvent& event);
 
     std::shared_ptr<EventBus> eventBus_;
-    std::shared_ptr<TextureManager> textureManager_;
+    std::shared_ptr<TextureManager> textureManager_;  // 无界面模式下为空
     std::map<std::string, std::shared_ptr<Material>> materials_;
     mutable std::mutex mutex_;
 };
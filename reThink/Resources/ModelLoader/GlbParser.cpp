@@ -0,0 +1,398 @@
+﻿#include "GlbParser.h"
+#include <atomic>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "Utils/MappedFile.h"
+
+using json = nlohmann::json;
+
+namespace {
+    constexpr uint32_t kGlbMagic = 0x46546C67;  // "glTF"
+    constexpr uint32_t kJsonChunk = 0x4E4F534A; // "JSON"
+    constexpr uint32_t kBinChunk = 0x004E4942;  // "BIN\0"
+    constexpr size_t kConvertGrainSize = 16384; // 逐元素转换的每块元素数
+    constexpr int kMaxNodeDepth = 1024;          // 节点层级上限，防止循环引用
+
+    enum ComponentType : uint32_t {
+        kByte = 5120,
+        kUnsignedByte = 5121,
+        kShort = 5122,
+        kUnsignedShort = 5123,
+        kUnsignedInt = 5125,
+        kFloat = 5126
+    };
+
+    enum PrimitiveMode : int {
+        kTriangles = 4,
+        kTriangleStrip = 5,
+        kTriangleFan = 6
+    };
+
+    /**
+     * @brief 指向 BIN 块的访问器视图，不拷贝数据。
+     */
+    struct AccessorView {
+        const uint8_t* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        uint32_t componentType = 0;
+        size_t components = 0;
+        bool normalized = false;
+    };
+
+    [[noreturn]] void Fail(const std::string& message) {
+        throw std::runtime_error("GlbParser: " + message);
+    }
+
+    uint32_t ReadU32(const uint8_t* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    size_t ComponentSize(uint32_t componentType) {
+        switch (componentType) {
+        case kByte:
+        case kUnsignedByte: return 1;
+        case kShort:
+        case kUnsignedShort: return 2;
+        case kUnsignedInt:
+        case kFloat: return 4;
+        default: Fail("未知的分量类型 " + std::to_string(componentType));
+        }
+    }
+
+    size_t ComponentCount(const std::string& type) {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4" || type == "MAT2") return 4;
+        if (type == "MAT3") return 9;
+        if (type == "MAT4") return 16;
+        Fail("未知的访问器类型 " + type);
+    }
+
+    AccessorView GetAccessor(const json& gltf, size_t index, const uint8_t* bin, size_t binSize) {
+        const json& accessor = gltf.at("accessors").at(index);
+        if (accessor.contains("sparse")) throw GlbUnsupportedException("不支持稀疏访问器");
+        if (!accessor.contains("bufferView")) throw GlbUnsupportedException("不支持没有缓冲视图的访问器");
+        const json& view = gltf.at("bufferViews").at(accessor.at("bufferView").get<size_t>());
+        if (view.value("buffer", size_t(0)) != 0 || gltf.at("buffers").at(0).contains("uri")) {
+            throw GlbUnsupportedException("不支持外部缓冲");
+        }
+
+        AccessorView result;
+        result.count = accessor.at("count").get<size_t>();
+        result.componentType = accessor.at("componentType").get<uint32_t>();
+        result.components = ComponentCount(accessor.at("type").get<std::string>());
+        result.normalized = accessor.value("normalized", false);
+        const size_t elementSize = ComponentSize(result.componentType) * result.components;
+        result.stride = view.value("byteStride", size_t(0));
+        if (result.stride == 0) result.stride = elementSize;
+
+        // 最后一个元素须完整落在缓冲视图内，缓冲视图须落在 BIN 块内
+        const size_t viewOffset = view.value("byteOffset", size_t(0));
+        const size_t viewLength = view.at("byteLength").get<size_t>();
+        const size_t offset = accessor.value("byteOffset", size_t(0));
+        if (viewOffset > binSize || viewLength > binSize - viewOffset || result.stride < elementSize) {
+            Fail("缓冲视图越界");
+        }
+        if (result.count > 0 && (offset > viewLength || elementSize > viewLength - offset ||
+                                 result.count - 1 > (viewLength - offset - elementSize) / result.stride)) {
+            Fail("访问器越界");
+        }
+        result.data = bin + viewOffset + offset;
+        return result;
+    }
+
+    float ReadComponent(const uint8_t* p, uint32_t componentType, bool normalized) {
+        switch (componentType) {
+        case kFloat: { float v; std::memcpy(&v, p, 4); return v; }
+        case kByte: { int8_t v; std::memcpy(&v, p, 1); return normalized ? std::max(v / 127.0f, -1.0f) : v; }
+        case kUnsignedByte: return normalized ? p[0] / 255.0f : p[0];
+        case kShort: { int16_t v; std::memcpy(&v, p, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+        case kUnsignedShort: { uint16_t v; std::memcpy(&v, p, 2); return normalized ? v / 65535.0f : v; }
+        case kUnsignedInt: { uint32_t v; std::memcpy(&v, p, 4); return static_cast<float>(v); }
+        default: return 0.0f;
+        }
+    }
+
+    uint32_t ReadIndex(const uint8_t* p, uint32_t componentType) {
+        switch (componentType) {
+        case kUnsignedByte: return p[0];
+        case kUnsignedShort: { uint16_t v; std::memcpy(&v, p, 2); return v; }
+        default: { uint32_t v; std::memcpy(&v, p, 4); return v; }
+        }
+    }
+
+    void ReadVec3(const AccessorView& view, glm::vec3* out, ThreadPool& threadPool) {
+        if (view.components != 3) Fail("顶点属性须为 VEC3");
+        if (view.componentType == kFloat && view.stride == sizeof(glm::vec3)) {
+            if (view.count > 0) std::memcpy(out, view.data, view.count * sizeof(glm::vec3));
+            return;
+        }
+        const size_t componentSize = ComponentSize(view.componentType);
+        threadPool.ParallelFor(0, view.count, kConvertGrainSize, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint8_t* p = view.data + i * view.stride;
+                out[i] = glm::vec3(ReadComponent(p, view.componentType, view.normalized),
+                                   ReadComponent(p + componentSize, view.componentType, view.normalized),
+                                   ReadComponent(p + 2 * componentSize, view.componentType, view.normalized));
+            }
+        });
+    }
+
+    /**
+     * @brief 读取索引并检查范围，写入时加上图元在节点中的顶点起点。
+     */
+    void ReadIndices(const AccessorView& view, unsigned int* out, size_t vertexCount, unsigned int baseVertex, ThreadPool& threadPool) {
+        if (view.components != 1 || (view.componentType != kUnsignedByte && view.componentType != kUnsignedShort &&
+                                      view.componentType != kUnsignedInt)) {
+            Fail("索引须为无符号整数标量");
+        }
+        const bool direct = view.componentType == kUnsignedInt && view.stride == sizeof(uint32_t);
+        if (direct && view.count > 0) {
+            std::memcpy(out, view.data, view.count * sizeof(uint32_t));
+        }
+        std::atomic<bool> outOfRange{false};
+        threadPool.ParallelFor(0, view.count, kConvertGrainSize, [&](size_t begin, size_t end) {
+            bool bad = false;
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t index = direct ? out[i] : ReadIndex(view.data + i * view.stride, view.componentType);
+                bad |= index >= vertexCount;
+                out[i] = baseVertex + index;
+            }
+            if (bad) outOfRange = true;
+        });
+        if (outOfRange) Fail("索引越界");
+    }
+
+    MeshCache::Material ReadMaterial(const json& gltf, const json& primitive) {
+        // 与 Assimp 的 glTF 导入一致：漫反射取基础颜色，没有材质时使用白色默认材质
+        MeshCache::Material material{glm::vec3(1.0f), glm::vec3(0.0f), 0.0f, ""};
+        if (!primitive.contains("material")) return material;
+        const json& source = gltf.at("materials").at(primitive.at("material").get<size_t>());
+        const json pbr = source.value("pbrMetallicRoughness", json::object());
+        if (pbr.contains("baseColorFactor")) {
+            const json& color = pbr.at("baseColorFactor");
+            material.diffuse = glm::vec3(color.at(0).get<float>(), color.at(1).get<float>(), color.at(2).get<float>());
+        }
+        if (pbr.contains("baseColorTexture")) {
+            const json& texture = gltf.at("textures").at(pbr.at("baseColorTexture").at("index").get<size_t>());
+            if (texture.contains("source")) {
+                const size_t imageIndex = texture.at("source").get<size_t>();
+                const json& image = gltf.at("images").at(imageIndex);
+                // 内嵌图像沿用 Assimp 的 "*索引" 写法
+                material.texturePath = image.contains("uri") ? image.at("uri").get<std::string>() : "*" + std::to_string(imageIndex);
+            }
+        }
+        return material;
+    }
+
+    glm::mat4 ReadTransform(const json& node) {
+        if (node.contains("matrix")) {
+            const json& m = node.at("matrix");
+            glm::mat4 transform(1.0f);
+            for (int column = 0; column < 4; ++column) {
+                for (int row = 0; row < 4; ++row) {
+                    transform[column][row] = m.at(column * 4 + row).get<float>();
+                }
+            }
+            return transform;
+        }
+        glm::vec3 translation(0.0f), scale(1.0f);
+        glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+        if (node.contains("translation")) {
+            const json& t = node.at("translation");
+            translation = glm::vec3(t.at(0).get<float>(), t.at(1).get<float>(), t.at(2).get<float>());
+        }
+        if (node.contains("rotation")) {
+            const json& r = node.at("rotation"); // glTF 的顺序为 (x, y, z, w)
+            rotation = glm::quat(r.at(3).get<float>(), r.at(0).get<float>(), r.at(1).get<float>(), r.at(2).get<float>());
+        }
+        if (node.contains("scale")) {
+            const json& s = node.at("scale");
+            scale = glm::vec3(s.at(0).get<float>(), s.at(1).get<float>(), s.at(2).get<float>());
+        }
+        return glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+    }
+
+    /**
+     * @brief 为 [firstVertex, 末尾) 的顶点按 [firstIndex, 末尾) 的三角形生成面积加权的平滑法线。
+     */
+    void GenerateNormals(MeshCache::Node& node, size_t firstVertex, size_t firstIndex) {
+        for (size_t i = firstIndex; i + 2 < node.indices.size(); i += 3) {
+            const glm::vec3& a = node.vertices[node.indices[i]];
+            const glm::vec3& b = node.vertices[node.indices[i + 1]];
+            const glm::vec3& c = node.vertices[node.indices[i + 2]];
+            const glm::vec3 faceNormal = glm::cross(b - a, c - a);
+            for (size_t k = 0; k < 3; ++k) {
+                node.normals[node.indices[i + k]] += faceNormal;
+            }
+        }
+        for (size_t i = firstVertex; i < node.normals.size(); ++i) {
+            const float length = glm::length(node.normals[i]);
+            if (length > 0.0f) node.normals[i] /= length;
+        }
+    }
+
+    class SceneBuilder {
+    public:
+        SceneBuilder(const json& gltf, const uint8_t* bin, size_t binSize, ThreadPool& threadPool)
+            : gltf_(gltf), bin_(bin), binSize_(binSize), threadPool_(threadPool) {}
+
+        void AddNode(size_t nodeIndex, int32_t parent, int depth, MeshCache::Scene& scene) {
+            if (depth > kMaxNodeDepth) Fail("节点层级过深或存在循环引用");
+            const json& source = gltf_.at("nodes").at(nodeIndex);
+            // 子节点追加时 nodes 可能扩容，这里按下标访问而不保留引用
+            const int32_t index = static_cast<int32_t>(scene.nodes.size());
+            scene.nodes.emplace_back();
+            scene.nodes[index].parent = parent;
+            scene.nodes[index].transform = ReadTransform(source);
+            if (source.contains("mesh")) {
+                const json& mesh = gltf_.at("meshes").at(source.at("mesh").get<size_t>());
+                for (const json& primitive : mesh.at("primitives")) {
+                    AddPrimitive(primitive, scene.nodes[index]);
+                }
+            }
+            for (const json& child : source.value("children", json::array())) {
+                AddNode(child.get<size_t>(), index, depth + 1, scene);
+            }
+        }
+
+    private:
+        void AddPrimitive(const json& primitive, MeshCache::Node& node) {
+            const int mode = primitive.value("mode", static_cast<int>(kTriangles));
+            const json& attributes = primitive.at("attributes");
+            if ((mode != kTriangles && mode != kTriangleStrip && mode != kTriangleFan) || !attributes.contains("POSITION")) {
+                return;
+            }
+
+            const AccessorView positions = GetAccessor(gltf_, attributes.at("POSITION").get<size_t>(), bin_, binSize_);
+            const size_t baseVertex = node.vertices.size();
+            if (baseVertex + positions.count > std::numeric_limits<unsigned int>::max()) Fail("顶点数量超出 32 位索引范围");
+            node.vertices.resize(baseVertex + positions.count);
+            ReadVec3(positions, node.vertices.data() + baseVertex, threadPool_);
+
+            bool hasNormals = false;
+            node.normals.resize(baseVertex + positions.count, glm::vec3(0.0f));
+            if (attributes.contains("NORMAL")) {
+                const AccessorView normals = GetAccessor(gltf_, attributes.at("NORMAL").get<size_t>(), bin_, binSize_);
+                if (normals.count == positions.count) {
+                    ReadVec3(normals, node.normals.data() + baseVertex, threadPool_);
+                    hasNormals = true;
+                }
+            }
+
+            // 三角形列表直接写入节点；带与扇先读到临时缓冲再展开
+            const size_t baseIndex = node.indices.size();
+            std::vector<unsigned int> temporary;
+            std::vector<unsigned int>& target = mode == kTriangles ? node.indices : temporary;
+            const size_t targetBase = mode == kTriangles ? baseIndex : 0;
+            const unsigned int offset = mode == kTriangles ? static_cast<unsigned int>(baseVertex) : 0;
+            if (primitive.contains("indices")) {
+                const AccessorView indices = GetAccessor(gltf_, primitive.at("indices").get<size_t>(), bin_, binSize_);
+                target.resize(targetBase + indices.count);
+                ReadIndices(indices, target.data() + targetBase, positions.count, offset, threadPool_);
+            } else {
+                target.resize(targetBase + positions.count);
+                for (size_t i = 0; i < positions.count; ++i) {
+                    target[targetBase + i] = offset + static_cast<unsigned int>(i);
+                }
+            }
+            if (mode == kTriangles) {
+                node.indices.resize(baseIndex + (node.indices.size() - baseIndex) / 3 * 3);
+            } else {
+                const unsigned int base = static_cast<unsigned int>(baseVertex);
+                for (size_t i = 2; i < temporary.size(); ++i) {
+                    unsigned int a, b;
+                    if (mode == kTriangleFan) {
+                        a = temporary[0];
+                        b = temporary[i - 1];
+                    } else if (i % 2 == 0) {
+                        a = temporary[i - 2];
+                        b = temporary[i - 1];
+                    } else {
+                        // 三角形带的奇数三角形交换前两个顶点以保持绕序
+                        a = temporary[i - 1];
+                        b = temporary[i - 2];
+                    }
+                    node.indices.insert(node.indices.end(), {base + a, base + b, base + temporary[i]});
+                }
+            }
+
+            if (!hasNormals) {
+                GenerateNormals(node, baseVertex, baseIndex);
+            }
+            node.materials.push_back(ReadMaterial(gltf_, primitive));
+        }
+
+        const json& gltf_;
+        const uint8_t* bin_;
+        size_t binSize_;
+        ThreadPool& threadPool_;
+    };
+}
+
+MeshCache::Scene GlbParser::Parse(const std::string& filepath, ThreadPool& threadPool) {
+    MappedFile file;
+    try {
+        file = MappedFile(filepath);
+    } catch (const MappedFileException& e) {
+        Fail(e.what());
+    }
+    const uint8_t* data = file.Data();
+    const size_t size = file.Size();
+
+    // 文件头 12 字节：magic、版本、总长度；随后是 JSON 块与可选的 BIN 块，每块前有长度与类型
+    if (size < 20 || ReadU32(data) != kGlbMagic) Fail("不是 GLB 文件: " + filepath);
+    if (ReadU32(data + 4) != 2) throw GlbUnsupportedException("只支持 glTF 2.0");
+    const size_t length = std::min<size_t>(ReadU32(data + 8), size);
+    const size_t jsonLength = ReadU32(data + 12);
+    if (ReadU32(data + 16) != kJsonChunk || jsonLength > length - 20) Fail("JSON 块无效");
+    const uint8_t* bin = nullptr;
+    size_t binSize = 0;
+    const size_t binHeader = 20 + jsonLength;
+    if (binHeader + 8 <= length && ReadU32(data + binHeader + 4) == kBinChunk) {
+        binSize = std::min<size_t>(ReadU32(data + binHeader), length - binHeader - 8);
+        bin = data + binHeader + 8;
+    }
+
+    try {
+        const json gltf = json::parse(data + 20, data + 20 + jsonLength);
+        for (const json& extension : gltf.value("extensionsRequired", json::array())) {
+            throw GlbUnsupportedException("不支持必需的扩展 " + extension.get<std::string>());
+        }
+
+        MeshCache::Scene scene;
+        scene.nodes.emplace_back();
+        scene.nodes[0].transform = glm::mat4(1.0f);
+        SceneBuilder builder(gltf, bin, binSize, threadPool);
+        if (gltf.contains("scenes")) {
+            const json& root = gltf.at("scenes").at(gltf.value("scene", size_t(0)));
+            for (const json& node : root.value("nodes", json::array())) {
+                builder.AddNode(node.get<size_t>(), 0, 0, scene);
+            }
+        } else {
+            // 没有场景时把不是任何节点子节点的节点作为根
+            const json nodes = gltf.value("nodes", json::array());
+            std::vector<bool> isChild(nodes.size(), false);
+            for (const json& node : nodes) {
+                for (const json& child : node.value("children", json::array())) {
+                    isChild.at(child.get<size_t>()) = true;
+                }
+            }
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (!isChild[i]) builder.AddNode(i, 0, 0, scene);
+            }
+        }
+        return scene;
+    } catch (const json::exception& e) {
+        Fail(std::string("JSON 无效: ") + e.what());
+    }
+}
\ No newline at end of file
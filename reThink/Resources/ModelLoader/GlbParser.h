@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <string>
+#include <stdexcept>
+#include "MeshCache.h"
+#include "ThreadPool/ThreadPool.h"
+
+/**
+ * @brief GLB 文件使用了快速路径不支持的特性，调用方应改用 Assimp 导入。
+ */
+class GlbUnsupportedException : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief 直接从映射的 GLB 文件读取网格的快速路径，不经过 Assimp。
+ *
+ * 只解析 JSON 块，访问器作为指向 BIN 块的视图读取：布局与目标一致时（紧密排列的 float3、
+ * 无偏移的 uint32 索引）整块拷贝，其余布局（交错的步长、uint8/uint16 索引、归一化整数分量）
+ * 并行逐元素转换。三角形带与三角形扇展开为三角形列表，点与线图元被忽略。
+ *
+ * 节点层级与变换按 glTF 场景保留，根节点为单位变换，其子节点为场景的根节点；每个节点的
+ * 所有图元合并到同一节点，每个图元一个材质。缺少法线的图元按面积加权生成平滑法线。
+ */
+class GlbParser {
+public:
+    /**
+     * @brief 解析 GLB 文件。
+     * @param filepath 文件路径。
+     * @param threadPool 用于并行转换的线程池，可在其工作线程中调用。
+     * @return MeshCache::Scene 按先序排列的节点数据。
+     * @throws GlbUnsupportedException 使用了外部缓冲、稀疏访问器或必需的扩展时抛出。
+     * @throws std::runtime_error 文件无法读取或格式错误时抛出。
+     */
+    static MeshCache::Scene Parse(const std::string& filepath, ThreadPool& threadPool);
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+﻿#include "ImporterPool.h"
+
+ImporterPool::Lease::Lease(ImporterPool& pool, std::unique_ptr<Assimp::Importer> importer)
+    : pool_(&pool), importer_(std::move(importer)) {}
+
+ImporterPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), importer_(std::move(other.importer_)) {}
+
+ImporterPool::Lease::~Lease() {
+    if (importer_) {
+        pool_->Release(std::move(importer_));
+    }
+}
+
+ImporterPool::ImporterPool(size_t maxIdle) : maxIdle_(maxIdle), createdCount_(0) {}
+
+ImporterPool::Lease ImporterPool::Acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty()) {
+            std::unique_ptr<Assimp::Importer> importer = std::move(idle_.back());
+            idle_.pop_back();
+            return Lease(*this, std::move(importer));
+        }
+        createdCount_++;
+    }
+    // 构造导入器会注册全部格式的加载器，在锁外进行
+    return Lease(*this, std::make_unique<Assimp::Importer>());
+}
+
+void ImporterPool::Release(std::unique_ptr<Assimp::Importer> importer) {
+    // 场景在归还前释放，空闲的导入器不占用模型数据
+    importer->FreeScene();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_.size() < maxIdle_) {
+        idle_.push_back(std::move(importer));
+    }
+}
+
+size_t ImporterPool::GetIdleCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
+
+size_t ImporterPool::GetCreatedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return createdCount_;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <assimp/Importer.hpp>
+
+/**
+ * @brief Assimp 导入器池。
+ *
+ * Assimp::Importer 不是线程安全的，导入得到的场景也归导入器所有。每次导入从池中借出一个
+ * 独占的导入器，多个模型可以在不同线程上同时导入；借用对象析构时释放场景并归还导入器。
+ * 空闲的导入器会被复用，空闲数量超过上限时归还的导入器直接销毁。
+ */
+class ImporterPool {
+public:
+    /**
+     * @brief 借出的导入器，析构时自动归还，持有期间导入得到的场景保持有效。
+     */
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease();
+
+        Assimp::Importer& operator*() const { return *importer_; }
+        Assimp::Importer* operator->() const { return importer_.get(); }
+
+    private:
+        friend class ImporterPool;
+        Lease(ImporterPool& pool, std::unique_ptr<Assimp::Importer> importer);
+
+        ImporterPool* pool_;
+        std::unique_ptr<Assimp::Importer> importer_;
+    };
+
+    /**
+     * @param maxIdle 保留的空闲导入器数量上限，通常取并发导入的线程数。
+     */
+    explicit ImporterPool(size_t maxIdle);
+
+    ImporterPool(const ImporterPool&) = delete;
+    ImporterPool& operator=(const ImporterPool&) = delete;
+
+    /**
+     * @brief 借出一个导入器，没有空闲导入器时新建，不会阻塞。
+     */
+    Lease Acquire();
+
+    size_t GetIdleCount() const;
+    // 累计创建的导入器数量，即同时导入的最大数量
+    size_t GetCreatedCount() const;
+
+private:
+    void Release(std::unique_ptr<Assimp::Importer> importer);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Assimp::Importer>> idle_;
+    size_t maxIdle_;
+    size_t createdCount_;
+};
\ No newline at end of file
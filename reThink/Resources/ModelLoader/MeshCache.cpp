@@ -0,0 +1,275 @@
+﻿#include "MeshCache.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+#include "Utils/MappedFile.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr char kMagic[4] = {'R', 'T', 'M', 'C'};
+    // 布局改变时递增，旧版本的缓存文件视为未命中并被覆盖
+    constexpr uint32_t kFormatVersion = 1;
+    constexpr uint64_t kArrayAlignment = 16;
+
+    static_assert(sizeof(glm::vec3) == 12, "glm::vec3 must be tightly packed");
+    static_assert(sizeof(glm::mat4) == 64, "glm::mat4 must be tightly packed");
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t importFlags;
+        uint32_t nodeCount;
+        uint64_t sourceSize;
+        int64_t sourceTime;      // 源文件修改时间的时钟计数
+        uint64_t pathOffset;
+        uint64_t pathLength;
+        uint64_t nodeOffset;
+        uint64_t materialOffset;
+        uint64_t materialCount;
+        uint64_t fileSize;
+    };
+
+    struct NodeRecord {
+        int32_t parent;
+        uint32_t materialCount;
+        uint64_t firstMaterial;
+        float transform[16];
+        uint64_t vertexOffset;
+        uint64_t vertexCount;
+        uint64_t normalOffset;
+        uint64_t normalCount;
+        uint64_t indexOffset;
+        uint64_t indexCount;
+    };
+
+    struct MaterialRecord {
+        float diffuse[3];
+        float specular[3];
+        float shininess;
+        uint32_t texturePathLength;
+        uint64_t texturePathOffset;
+    };
+
+    static_assert(std::is_trivially_copyable_v<FileHeader> && std::is_trivially_copyable_v<NodeRecord> &&
+                  std::is_trivially_copyable_v<MaterialRecord>, "records are copied as raw bytes");
+
+    uint64_t Align(uint64_t offset) {
+        return (offset + kArrayAlignment - 1) / kArrayAlignment * kArrayAlignment;
+    }
+
+    uint64_t Fnv1a(const std::string& text) {
+        uint64_t hash = 1469598103934665603ull;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool InBounds(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize) {
+        return offset <= fileSize && count <= (fileSize - offset) / elementSize;
+    }
+
+    template<typename T>
+    std::vector<T> CopyArray(const uint8_t* base, uint64_t offset, uint64_t count) {
+        std::vector<T> values(static_cast<size_t>(count));
+        if (count > 0) std::memcpy(values.data(), base + offset, static_cast<size_t>(count) * sizeof(T));
+        return values;
+    }
+
+    /**
+     * @brief 读取源文件的大小与修改时间，文件不存在时返回 false。
+     */
+    bool StatSource(const fs::path& source, uint64_t& size, int64_t& time) {
+        std::error_code ec;
+        size = fs::file_size(source, ec);
+        if (ec) return false;
+        auto modified = fs::last_write_time(source, ec);
+        if (ec) return false;
+        time = static_cast<int64_t>(modified.time_since_epoch().count());
+        return true;
+    }
+}
+
+MeshCache::MeshCache(const fs::path& directory) : directory_(directory) {}
+
+fs::path MeshCache::CachePathFor(const fs::path& absoluteSource) const {
+    static const char* digits = "0123456789abcdef";
+    uint64_t hash = Fnv1a(absoluteSource.generic_string());
+    std::string name(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        name[i] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+    return directory_ / (name + ".mesh");
+}
+
+std::optional<MeshCache::Scene> MeshCache::Load(const std::string& sourcePath, uint32_t importFlags) const {
+    std::error_code ec;
+    const fs::path source = fs::absolute(sourcePath, ec);
+    if (ec) return std::nullopt;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!StatSource(source, sourceSize, sourceTime)) return std::nullopt;
+    const fs::path cachePath = CachePathFor(source);
+    if (!fs::exists(cachePath, ec)) return std::nullopt;
+
+    MappedFile file;
+    try {
+        file = MappedFile(cachePath);
+    } catch (const MappedFileException&) {
+        return std::nullopt;
+    }
+    const uint8_t* base = file.Data();
+    const uint64_t fileSize = file.Size();
+    if (fileSize < sizeof(FileHeader)) return std::nullopt;
+
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    const std::string sourceKey = source.generic_string();
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion ||
+        header.importFlags != importFlags || header.sourceSize != sourceSize || header.sourceTime != sourceTime ||
+        header.fileSize != fileSize || header.pathLength != sourceKey.size() ||
+        !InBounds(header.pathOffset, header.pathLength, 1, fileSize) ||
+        std::memcmp(base + header.pathOffset, sourceKey.data(), sourceKey.size()) != 0 ||
+        !InBounds(header.nodeOffset, header.nodeCount, sizeof(NodeRecord), fileSize) ||
+        !InBounds(header.materialOffset, header.materialCount, sizeof(MaterialRecord), fileSize) ||
+        header.nodeCount == 0) {
+        return std::nullopt;
+    }
+
+    Scene scene;
+    scene.nodes.resize(header.nodeCount);
+    for (uint32_t i = 0; i < header.nodeCount; ++i) {
+        NodeRecord record;
+        std::memcpy(&record, base + header.nodeOffset + i * sizeof(NodeRecord), sizeof(record));
+        if (record.parent >= static_cast<int32_t>(i) || record.parent < -1 || (i == 0) != (record.parent == -1) ||
+            !InBounds(record.vertexOffset, record.vertexCount, sizeof(glm::vec3), fileSize) ||
+            !InBounds(record.normalOffset, record.normalCount, sizeof(glm::vec3), fileSize) ||
+            !InBounds(record.indexOffset, record.indexCount, sizeof(unsigned int), fileSize) ||
+            record.firstMaterial > header.materialCount || record.materialCount > header.materialCount - record.firstMaterial) {
+            return std::nullopt;
+        }
+
+        Node& node = scene.nodes[i];
+        node.parent = record.parent;
+        std::memcpy(&node.transform, record.transform, sizeof(record.transform));
+        node.vertices = CopyArray<glm::vec3>(base, record.vertexOffset, record.vertexCount);
+        node.normals = CopyArray<glm::vec3>(base, record.normalOffset, record.normalCount);
+        node.indices = CopyArray<unsigned int>(base, record.indexOffset, record.indexCount);
+        for (uint32_t m = 0; m < record.materialCount; ++m) {
+            MaterialRecord material;
+            std::memcpy(&material, base + header.materialOffset + (record.firstMaterial + m) * sizeof(MaterialRecord), sizeof(material));
+            if (!InBounds(material.texturePathOffset, material.texturePathLength, 1, fileSize)) return std::nullopt;
+            node.materials.push_back(Material{
+                glm::vec3(material.diffuse[0], material.diffuse[1], material.diffuse[2]),
+                glm::vec3(material.specular[0], material.specular[1], material.specular[2]),
+                material.shininess,
+                std::string(reinterpret_cast<const char*>(base + material.texturePathOffset), material.texturePathLength)});
+        }
+    }
+    return scene;
+}
+
+bool MeshCache::Store(const std::string& sourcePath, uint32_t importFlags, const Scene& scene) const {
+    std::error_code ec;
+    const fs::path source = fs::absolute(sourcePath, ec);
+    if (ec || scene.nodes.empty()) return false;
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.importFlags = importFlags;
+    header.nodeCount = static_cast<uint32_t>(scene.nodes.size());
+    if (!StatSource(source, header.sourceSize, header.sourceTime)) return false;
+    const std::string sourceKey = source.generic_string();
+
+    // 先计算布局：文件头、源路径、节点表、材质表、材质路径，最后是对齐的数组
+    std::vector<NodeRecord> nodes(scene.nodes.size());
+    std::vector<MaterialRecord> materials;
+    uint64_t offset = sizeof(FileHeader);
+    header.pathOffset = offset;
+    header.pathLength = sourceKey.size();
+    offset = Align(offset + sourceKey.size());
+    header.nodeOffset = offset;
+    offset += nodes.size() * sizeof(NodeRecord);
+    for (const auto& node : scene.nodes) {
+        header.materialCount += node.materials.size();
+    }
+    header.materialOffset = Align(offset);
+    offset = header.materialOffset + header.materialCount * sizeof(MaterialRecord);
+    for (size_t i = 0; i < scene.nodes.size(); ++i) {
+        const Node& node = scene.nodes[i];
+        NodeRecord& record = nodes[i];
+        record.parent = node.parent;
+        record.materialCount = static_cast<uint32_t>(node.materials.size());
+        record.firstMaterial = materials.size();
+        std::memcpy(record.transform, &node.transform, sizeof(record.transform));
+        for (const auto& material : node.materials) {
+            MaterialRecord materialRecord{};
+            std::memcpy(materialRecord.diffuse, &material.diffuse, sizeof(materialRecord.diffuse));
+            std::memcpy(materialRecord.specular, &material.specular, sizeof(materialRecord.specular));
+            materialRecord.shininess = material.shininess;
+            materialRecord.texturePathLength = static_cast<uint32_t>(material.texturePath.size());
+            materialRecord.texturePathOffset = offset;
+            offset += material.texturePath.size();
+            materials.push_back(materialRecord);
+        }
+    }
+    for (size_t i = 0; i < scene.nodes.size(); ++i) {
+        const Node& node = scene.nodes[i];
+        NodeRecord& record = nodes[i];
+        record.vertexOffset = offset = Align(offset);
+        record.vertexCount = node.vertices.size();
+        offset += node.vertices.size() * sizeof(glm::vec3);
+        record.normalOffset = offset = Align(offset);
+        record.normalCount = node.normals.size();
+        offset += node.normals.size() * sizeof(glm::vec3);
+        record.indexOffset = offset = Align(offset);
+        record.indexCount = node.indices.size();
+        offset += node.indices.size() * sizeof(unsigned int);
+    }
+    header.fileSize = offset;
+
+    std::vector<uint8_t> buffer(static_cast<size_t>(header.fileSize), 0);
+    auto put = [&](uint64_t at, const void* data, size_t size) {
+        if (size > 0) std::memcpy(buffer.data() + at, data, size);
+    };
+    put(0, &header, sizeof(header));
+    put(header.pathOffset, sourceKey.data(), sourceKey.size());
+    put(header.nodeOffset, nodes.data(), nodes.size() * sizeof(NodeRecord));
+    put(header.materialOffset, materials.data(), materials.size() * sizeof(MaterialRecord));
+    size_t materialIndex = 0;
+    for (size_t i = 0; i < scene.nodes.size(); ++i) {
+        const Node& node = scene.nodes[i];
+        for (const auto& material : node.materials) {
+            put(materials[materialIndex++].texturePathOffset, material.texturePath.data(), material.texturePath.size());
+        }
+        put(nodes[i].vertexOffset, node.vertices.data(), node.vertices.size() * sizeof(glm::vec3));
+        put(nodes[i].normalOffset, node.normals.data(), node.normals.size() * sizeof(glm::vec3));
+        put(nodes[i].indexOffset, node.indices.data(), node.indices.size() * sizeof(unsigned int));
+    }
+
+    // 先写临时文件再重命名，并发导入同一文件时读取方不会看到写了一半的缓存
+    fs::create_directories(directory_, ec);
+    const fs::path cachePath = CachePathFor(source);
+    fs::path temporary = cachePath;
+    temporary += ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) {
+            std::cerr << "[MeshCache] 写入失败: " << temporary.string() << std::endl;
+            file.close();
+            fs::remove(temporary, ec);
+            return false;
+        }
+    }
+    fs::rename(temporary, cachePath, ec);
+    if (ec) {
+        fs::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
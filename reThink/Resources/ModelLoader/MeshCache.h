@@ -0,0 +1,71 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <filesystem>
+#include <glm/glm.hpp>
+
+/**
+ * @brief 导入模型的二进制网格缓存。
+ *
+ * 每个源文件对应一个缓存文件，文件名为源文件绝对路径的哈希。缓存文件头记录格式版本、
+ * 导入标志以及源文件的路径、大小与修改时间，任何一项不一致时视为未命中，源文件改变或
+ * 导入选项改变后会重新导入并覆盖。
+ *
+ * 文件布局：文件头、源路径、节点表、材质表，随后是按 16 字节对齐的顶点、法线、索引数组，
+ * 节点表只记录各数组的偏移与长度。读取时映射整个文件，校验边界后按数组整块拷贝，
+ * 不做逐元素解析。数据使用本机字节序，缓存只在同一平台上复用。
+ */
+class MeshCache {
+public:
+    /**
+     * @brief 创建材质所需的参数，材质 UUID 在实例化时由 MaterialManager 生成。
+     */
+    struct Material {
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+        float shininess;
+        std::string texturePath;
+    };
+
+    /**
+     * @brief 场景中的一个节点，parent 为父节点下标，根节点为 -1。
+     */
+    struct Node {
+        int32_t parent = -1;
+        glm::mat4 transform;
+        std::vector<glm::vec3> vertices;
+        std::vector<glm::vec3> normals;
+        std::vector<unsigned int> indices;
+        std::vector<Material> materials;
+    };
+
+    /**
+     * @brief 与 UUID 无关的场景数据，nodes 按先序排列，nodes[0] 为根节点。
+     */
+    struct Scene {
+        std::vector<Node> nodes;
+    };
+
+    /**
+     * @param directory 缓存目录，不存在时在首次写入时创建。
+     */
+    explicit MeshCache(const std::filesystem::path& directory);
+
+    /**
+     * @brief 读取源文件的缓存，未命中、过期或文件损坏时返回空。
+     */
+    std::optional<Scene> Load(const std::string& sourcePath, uint32_t importFlags) const;
+
+    /**
+     * @brief 写入源文件的缓存。
+     * @return 是否写入成功，失败时不影响导入。
+     */
+    bool Store(const std::string& sourcePath, uint32_t importFlags, const Scene& scene) const;
+
+private:
+    std::filesystem::path CachePathFor(const std::filesystem::path& absoluteSource) const;
+
+    std::filesystem::path directory_;
+};
\ No newline at end of file
@@ -3,11 +3,29 @@
 #include <sstream>
 #include <random>
 #include <chrono>
+#include <optional>
+#include <iostream>
+#include <functional>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
 #include <glm/gtc/matrix_transform.hpp>
 #include "MaterialManager/MaterialManager.h"
+#include "ObjParser.h"
+#include "GlbParser.h"
+
+namespace {
+    std::string LowercaseExtension(const std::string& filepath) {
+        std::string extension = std::filesystem::path(filepath).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension;
+    }
+}
 
 ModelLoader::ModelLoader(std::shared_ptr<EventBus> eventBus, std::shared_ptr<ThreadPool> threadPool, std::shared_ptr<MaterialManager> materialManager)
-    : eventBus_(std::move(eventBus)), threadPool_(std::move(threadPool)), materialManager_(std::move(materialManager)) {
+    : eventBus_(std::move(eventBus)), threadPool_(std::move(threadPool)),
+      importerPool_(threadPool_ ? threadPool_->GetThreadCount() : 1), materialManager_(std::move(materialManager)) {
     if (!eventBus_) throw std::invalid_argument("ModelLoader: EventBus 不能为空");
     if (!threadPool_) throw std::invalid_argument("ModelLoader: ThreadPool 不能为空");
     if (!materialManager_) throw std::invalid_argument("ModelLoader: MaterialManager 不能为空");
@@ -18,12 +36,19 @@ ModelLoader::ModelLoader(std::shared_ptr<EventBus> eventBus, std::shared_ptr<Thr
     eventBus_->Subscribe<MyRenderer::Events::HierarchyUpdateEvent>(
         [this](const MyRenderer::Events::HierarchyUpdateEvent& event) {
             std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<ModelData*> children;
             for (auto& [uuid, model] : loadedModels_) {
                 if (model.parentUUID == event.parentUUID) {
-                    model.transform = event.transform * model.transform; // 应用父变换
-                    eventBus_->Publish(MyRenderer::Events::ModelTransformedEvent{uuid, model.transform});
+                    children.push_back(&model);
                 }
             }
+            // 子节点数量较多时并行应用父变换，事件仍按顺序发布
+            threadPool_->ParallelFor(0, children.size(), kHierarchyGrainSize, [&](size_t i) {
+                children[i]->transform = event.transform * children[i]->transform; // 应用父变换
+            });
+            for (const ModelData* child : children) {
+                eventBus_->Publish(MyRenderer::Events::ModelTransformedEvent{child->uuid, child->transform});
+            }
         });
 }
 
@@ -35,19 +60,99 @@ ModelLoader::~ModelLoader() {
 std::future<ModelData> ModelLoader::LoadModelAsync(const std::string& filepath, int priority) {
     if (filepath.empty()) throw std::invalid_argument("ModelLoader: 文件路径不能为空");
     return threadPool_->EnqueueTask([this, filepath]() -> ModelData {
-        const aiScene* scene = importer_.ReadFile(filepath,
-            aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices);
-        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-            throw std::runtime_error("ModelLoader: 无法加载模型 '" + filepath + "': " + importer_.GetErrorString());
+        return ImportModel(filepath);
+    }, priority);
+}
+
+ThreadPool::Task<ModelData> ModelLoader::LoadModelTask(const std::string& filepath, int priority) {
+    if (filepath.empty()) throw std::invalid_argument("ModelLoader: 文件路径不能为空");
+    return threadPool_->Async([this, filepath]() -> ModelData {
+        return ImportModel(filepath);
+    }, priority);
+}
+
+ThreadPool::Task<std::vector<ModelData>> ModelLoader::LoadModelsTask(const std::vector<std::string>& filepaths, int priority) {
+    std::vector<ThreadPool::Task<ModelData>> loads;
+    loads.reserve(filepaths.size());
+    for (const auto& filepath : filepaths) {
+        loads.push_back(LoadModelTask(filepath, priority));
+    }
+    return threadPool_->WhenAll(loads, priority);
+}
+
+ModelData ModelLoader::ImportModel(const std::string& filepath) {
+    const auto start = std::chrono::steady_clock::now();
+    std::optional<MeshCache::Scene> cooked;
+    const char* source = "GLB 直接读取";
+    if (IsGlbFile(filepath)) {
+        // GLB 中的数据本身已是二进制缓冲，直接读取比经过缓存更快，不写入网格缓存
+        try {
+            cooked = GlbParser::Parse(filepath, *threadPool_);
+        } catch (const GlbUnsupportedException& e) {
+            std::cout << "[ModelLoader] " << filepath << " 改用 Assimp 导入: " << e.what() << std::endl;
         }
-        ModelData modelData = ProcessScene(filepath, scene);
+    }
+
+    if (!cooked) {
+        std::shared_ptr<MeshCache> meshCache;
         {
             std::lock_guard<std::mutex> lock(mutex_);
-            loadedModels_[modelData.uuid] = modelData;
+            meshCache = meshCache_;
         }
-        eventBus_->Publish(MyRenderer::Events::ModelLoadedEvent{modelData});
-        return modelData;
-    }, priority);
+        // 两种解析方式的结果不同，缓存键分开
+        const bool nativeObj = UseNativeObjParser(filepath);
+        const uint32_t cacheFlags = nativeObj ? kNativeObjCacheFlags : kImportFlags;
+        if (meshCache) {
+            cooked = meshCache->Load(filepath, cacheFlags);
+        }
+        const bool cacheHit = cooked.has_value();
+        source = "缓存命中";
+        if (!cooked && nativeObj) {
+            ObjParser::Stats stats;
+            cooked = ObjParser::Parse(filepath, *threadPool_, &stats);
+            const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "[ModelLoader] OBJ 并行解析 " << stats.chunks << " 块，" << stats.triangles << " 个三角形，"
+                      << stats.bytes / (1024.0 * 1024.0) / std::max(seconds, 1e-9) << " MB/s" << std::endl;
+            source = "导入";
+        } else if (!cooked) {
+            cooked = ImportWithAssimp(filepath);
+            source = "导入";
+        }
+        if (meshCache && !cacheHit) {
+            meshCache->Store(filepath, cacheFlags, *cooked);
+        }
+    }
+    ModelData modelData = InstantiateScene(filepath, std::move(*cooked));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loadedModels_[modelData.uuid] = modelData;
+    }
+    eventBus_->Publish(MyRenderer::Events::ModelLoadedEvent{modelData});
+
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[ModelLoader] " << filepath << " " << source << "，耗时 " << elapsed << " ms" << std::endl;
+    return modelData;
+}
+
+MeshCache::Scene ModelLoader::ImportWithAssimp(const std::string& filepath) {
+    // 每个导入任务独占一个导入器，多个模型同时导入；场景数据归导入器所有，处理完成前不能归还
+    ImporterPool::Lease importer = importerPool_.Acquire();
+    const aiScene* scene = importer->ReadFile(filepath, kImportFlags);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        throw std::runtime_error("ModelLoader: 无法加载模型 '" + filepath + "': " + importer->GetErrorString());
+    }
+    return ProcessScene(scene);
+}
+
+bool ModelLoader::UseNativeObjParser(const std::string& filepath) {
+    if (LowercaseExtension(filepath) != ".obj") return false;
+    std::error_code ec;
+    const uintmax_t size = std::filesystem::file_size(filepath, ec);
+    return !ec && size >= kNativeObjMinBytes;
+}
+
+bool ModelLoader::IsGlbFile(const std::string& filepath) {
+    return LowercaseExtension(filepath) == ".glb";
 }
 
 void ModelLoader::DeleteModel(const std::string& modelUUID) {
@@ -67,20 +172,18 @@ ModelData ModelLoader::GetModelData(const std::string& modelUUID) const {
     return (it != loadedModels_.end()) ? it->second : ModelData{};
 }
 
-ModelData ModelLoader::ProcessScene(const std::string& filepath, const aiScene* scene) {
-    ModelData modelData;
-    modelData.uuid = GenerateUUID();
-    modelData.filepath = filepath;
-    modelData.transform = glm::mat4(1.0f);
-    modelData.vertexShaderPath = "";
-    modelData.fragmentShaderPath = "";
-    modelData.parentUUID = "";
+void ModelLoader::SetMeshCache(std::shared_ptr<MeshCache> meshCache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    meshCache_ = std::move(meshCache);
+}
 
-    ProcessNode(scene->mRootNode, scene, modelData, "");
-    return modelData;
+MeshCache::Scene ModelLoader::ProcessScene(const aiScene* scene) {
+    MeshCache::Scene result;
+    ProcessNode(scene->mRootNode, scene, result, -1);
+    return result;
 }
 
-void ModelLoader::ProcessNode(const aiNode* node, const aiScene* scene, ModelData& modelData, const std::string& parentUUID) {
+void ModelLoader::ProcessNode(const aiNode* node, const aiScene* scene, MeshCache::Scene& result, int32_t parentIndex) {
     aiMatrix4x4 aiTransform = node->mTransformation;
     glm::mat4 transform(
         aiTransform.a1, aiTransform.b1, aiTransform.c1, aiTransform.d1,
@@ -88,47 +191,59 @@ void ModelLoader::ProcessNode(const aiNode* node, const aiScene* scene, ModelDat
         aiTransform.a3, aiTransform.b3, aiTransform.c3, aiTransform.d3,
         aiTransform.a4, aiTransform.b4, aiTransform.c4, aiTransform.d4
     );
-    modelData.transform = transform;
-    modelData.parentUUID = parentUUID;
+    // 子节点追加时 nodes 可能扩容，这里按下标访问而不保留引用
+    const int32_t index = static_cast<int32_t>(result.nodes.size());
+    result.nodes.emplace_back();
+    result.nodes[index].parent = parentIndex;
+    result.nodes[index].transform = transform;
 
     for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
-        ProcessMesh(scene->mMeshes[node->mMeshes[i]], modelData, scene);
+        ProcessMesh(scene->mMeshes[node->mMeshes[i]], result.nodes[index], scene);
     }
 
     for (unsigned int i = 0; i < node->mNumChildren; ++i) {
-        ModelData childModelData;
-        childModelData.uuid = GenerateUUID();
-        childModelData.filepath = modelData.filepath;
-        childModelData.vertexShaderPath = "";
-        childModelData.fragmentShaderPath = "";
-        ProcessNode(node->mChildren[i], scene, childModelData, modelData.uuid);
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            loadedModels_[childModelData.uuid] = childModelData;
-        }
-        eventBus_->Publish(MyRenderer::Events::ModelLoadedEvent{childModelData});
+        ProcessNode(node->mChildren[i], scene, result, index);
     }
 }
 
-void ModelLoader::ProcessMesh(const aiMesh* mesh, ModelData& modelData, const aiScene* scene) {
-    // 加载顶点和法线数据
-    for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
-        glm::vec3 vertex(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
-        modelData.vertices.push_back(vertex);
-        if (mesh->HasNormals()) {
-            glm::vec3 normal(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
-            modelData.normals.push_back(normal);
-        } else {
-            // 如果没有法线，可以选择生成默认值或抛出警告
-            modelData.normals.push_back(glm::vec3(0.0f));
+void ModelLoader::ProcessMesh(const aiMesh* mesh, MeshCache::Node& node, const aiScene* scene) {
+    // 同一节点可能包含多个网格，索引需要偏移到当前网格顶点的起始位置
+    const size_t baseVertex = node.vertices.size();
+    const size_t vertexCount = mesh->mNumVertices;
+    const bool hasNormals = mesh->HasNormals();
+
+    // 加载顶点和法线数据：先一次性分配，再按块并行拷贝
+    node.vertices.resize(baseVertex + vertexCount);
+    node.normals.resize(baseVertex + vertexCount, glm::vec3(0.0f)); // 没有法线时保留默认值
+    threadPool_->ParallelFor(0, vertexCount, kMeshGrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            node.vertices[baseVertex + i] = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
         }
-    }
+        if (hasNormals) {
+            for (size_t i = begin; i < end; ++i) {
+                node.normals[baseVertex + i] = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+            }
+        }
+    });
 
-    // 加载索引数据
-    for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
-        const aiFace& face = mesh->mFaces[i];
-        for (unsigned int j = 0; j < face.mNumIndices; ++j) {
-            modelData.indices.push_back(face.mIndices[j]);
+    // 加载索引数据：纯三角形网格可直接按面并行写入，混合图元仍按顺序处理
+    if (mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE) {
+        const size_t baseIndex = node.indices.size();
+        node.indices.resize(baseIndex + static_cast<size_t>(mesh->mNumFaces) * 3);
+        threadPool_->ParallelFor(0, mesh->mNumFaces, kMeshGrainSize, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const aiFace& face = mesh->mFaces[i];
+                for (unsigned int j = 0; j < 3; ++j) {
+                    node.indices[baseIndex + i * 3 + j] = static_cast<unsigned int>(baseVertex + face.mIndices[j]);
+                }
+            }
+        });
+    } else {
+        for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+            const aiFace& face = mesh->mFaces[i];
+            for (unsigned int j = 0; j < face.mNumIndices; ++j) {
+                node.indices.push_back(static_cast<unsigned int>(baseVertex + face.mIndices[j]));
+            }
         }
     }
 
@@ -139,28 +254,68 @@ void ModelLoader::ProcessMesh(const aiMesh* mesh, ModelData& modelData, const ai
         aiMat->Get(AI_MATKEY_COLOR_DIFFUSE, diffuse);
         aiColor3D specular;
         aiMat->Get(AI_MATKEY_COLOR_SPECULAR, specular);
-        float shininess;
+        float shininess = 0.0f;
         aiMat->Get(AI_MATKEY_SHININESS, shininess);
 
         aiString texturePath;
         std::string filepath = (aiMat->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == AI_SUCCESS) ? texturePath.C_Str() : "";
 
-        // 委托给 MaterialManager 创建材质
-        std::string materialUUID = materialManager_->LoadMaterial(
+        // 只记录材质参数，实例化时再委托给 MaterialManager 创建材质
+        node.materials.push_back(MeshCache::Material{
             glm::vec3(diffuse.r, diffuse.g, diffuse.b),
             glm::vec3(specular.r, specular.g, specular.b),
             shininess,
             filepath
-        );
-        modelData.materialUUIDs.push_back(materialUUID);
+        });
     }
 }
 
+ModelData ModelLoader::InstantiateScene(const std::string& filepath, MeshCache::Scene scene) {
+    std::vector<ModelData> models(scene.nodes.size());
+    std::vector<std::vector<size_t>> children(scene.nodes.size());
+    for (size_t i = 0; i < scene.nodes.size(); ++i) {
+        MeshCache::Node& node = scene.nodes[i];
+        ModelData& model = models[i];
+        model.uuid = GenerateUUID();
+        model.filepath = filepath;
+        model.transform = node.transform;
+        model.vertices = std::move(node.vertices);
+        model.normals = std::move(node.normals);
+        model.indices = std::move(node.indices);
+        model.vertexShaderPath = "";
+        model.fragmentShaderPath = "";
+        // 先序排列保证父节点已生成 UUID
+        if (node.parent >= 0) {
+            model.parentUUID = models[node.parent].uuid;
+            children[node.parent].push_back(i);
+        }
+        for (const auto& material : node.materials) {
+            // 委托给 MaterialManager 创建材质
+            model.materialUUIDs.push_back(materialManager_->LoadMaterial(
+                material.diffuse, material.specular, material.shininess, material.texturePath));
+        }
+    }
+
+    // 按后序登记和发布子节点，订阅者收到某个节点时其子树已全部就绪
+    std::function<void(size_t)> publish = [&](size_t index) {
+        for (size_t child : children[index]) {
+            publish(child);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                loadedModels_[models[child].uuid] = models[child];
+            }
+            eventBus_->Publish(MyRenderer::Events::ModelLoadedEvent{models[child]});
+        }
+    };
+    publish(0);
+    return std::move(models[0]);
+}
+
 std::string ModelLoader::GenerateUUID() const {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, 15);
-    static std::uniform_int_distribution<> dis2(8, 11);
+    // 多个导入任务会并发生成 UUID，随机数状态按线程独立
+    thread_local std::mt19937 gen(std::random_device{}());
+    thread_local std::uniform_int_distribution<> dis(0, 15);
+    thread_local std::uniform_int_distribution<> dis2(8, 11);
 
     auto now = std::chrono::system_clock::now().time_since_epoch().count();
     std::stringstream ss;
@@ -11,6 +11,8 @@
 #include "EventBus/EventBus.h"
 #include "ThreadPool/ThreadPool.h"
 #include "EventBus/EventTypes.h"
+#include "ImporterPool.h"
+#include "MeshCache.h"
 class MaterialManager;
 
 class ModelLoader {
@@ -35,6 +37,22 @@ public:
      */
     std::future<ModelData> LoadModelAsync(const std::string& filepath, int priority = 0);
 
+    /**
+     * @brief 以任务图节点的形式加载模型，可用 Then()/WhenAll() 串联后续处理而不阻塞工作线程。
+     * @param filepath 模型文件路径。
+     * @param priority 任务优先级，默认为 0。
+     * @return ThreadPool::Task<ModelData> 加载任务。
+     */
+    ThreadPool::Task<ModelData> LoadModelTask(const std::string& filepath, int priority = 0);
+
+    /**
+     * @brief 并行加载一组模型，全部完成后按输入顺序汇总结果。
+     * @param filepaths 模型文件路径列表。
+     * @param priority 任务优先级，默认为 0。
+     * @return ThreadPool::Task<std::vector<ModelData>> 汇总任务。
+     */
+    ThreadPool::Task<std::vector<ModelData>> LoadModelsTask(const std::vector<std::string>& filepaths, int priority = 0);
+
     /**
      * @brief 删除指定模型并发布删除事件。
      * @param modelUUID 模型的唯一标识符。
@@ -48,36 +66,79 @@ public:
      */
     ModelData GetModelData(const std::string& modelUUID) const;
 
+    /**
+     * @brief 设置网格缓存，之后导入的模型优先从缓存读取，未命中时导入并写入缓存。
+     * @param meshCache 网格缓存，为空时不使用缓存。
+     */
+    void SetMeshCache(std::shared_ptr<MeshCache> meshCache);
+
 private:
+    static constexpr size_t kMeshGrainSize = 16384;     // 网格数据并行拷贝的每块元素数
+    static constexpr size_t kHierarchyGrainSize = 1024; // 层级变换并行传播的每块节点数
+    // Assimp 后处理标志，同时作为网格缓存键的一部分
+    static constexpr uint32_t kImportFlags =
+        aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices;
+    // 不小于该大小的 OBJ 文件由 ObjParser 并行解析，较小的文件仍交给 Assimp 以保留材质与分组
+    static constexpr uintmax_t kNativeObjMinBytes = 64ull * 1024 * 1024;
+    // ObjParser 结果的缓存键标志，不经过 Assimp 后处理，与任何 Assimp 标志组合都不同
+    static constexpr uint32_t kNativeObjCacheFlags = 0;
+
     /**
-     * @brief 处理 Assimp 加载的场景数据，转换为 ModelData。
+     * @brief 在当前线程导入模型、登记缓存并发布 ModelLoadedEvent。
      * @param filepath 模型文件路径。
+     * @return ModelData 导入的模型数据。
+     */
+    ModelData ImportModel(const std::string& filepath);
+
+    /**
+     * @brief 使用 Assimp 导入模型文件。
+     * @param filepath 模型文件路径。
+     * @return MeshCache::Scene 导入的场景。
+     */
+    MeshCache::Scene ImportWithAssimp(const std::string& filepath);
+
+    /**
+     * @brief 是否使用 ObjParser 代替 Assimp 解析该文件。
+     */
+    static bool UseNativeObjParser(const std::string& filepath);
+
+    /**
+     * @brief 是否为 GLB 文件，GLB 文件先尝试由 GlbParser 直接读取。
+     */
+    static bool IsGlbFile(const std::string& filepath);
+
+    /**
+     * @brief 处理 Assimp 加载的场景数据，转换为与 UUID 无关、可写入缓存的场景。
      * @param scene Assimp 加载的场景对象。
-     * @return ModelData 转换后的模型数据。
+     * @return MeshCache::Scene 按先序排列的节点数据。
      */
-    ModelData ProcessScene(const std::string& filepath, const aiScene* scene);
+    MeshCache::Scene ProcessScene(const aiScene* scene);
 
     /**
      * @brief 处理 Assimp（Asset Importer）库中的一个节点，包括其子节点和网格数据。
      * 
      * @param node 指向 aiNode 对象的指针，表示要处理的节点。
      * @param scene 指向 aiScene 对象的指针，表示整个场景，用于访问节点和网格数据。
-     * @param modelData ModelData 对象的引用，用于存储处理后的模型数据。
-     * @param parentUUID 父节点的 UUID，用于建立节点之间的层级关系。
-     * 
-     * 该函数主要用于遍历和处理场景中的节点及其子节点。
-     * 它会处理节点的网格数据（如果有），并将相关数据存储到 modelData 对象中。
-     * 函数还通过传递 parentUUID 来处理节点之间的层级关系，建立父子关系。
-     * 注意：该函数不处理节点的变换属性，例如位置、旋转和缩放。
+     * @param result 目标场景，节点按先序追加。
+     * @param parentIndex 父节点在 result 中的下标，根节点为 -1。
      */
-    void ProcessNode(const aiNode* node, const aiScene* scene, ModelData& modelData, const std::string& parentUUID);
+    void ProcessNode(const aiNode* node, const aiScene* scene, MeshCache::Scene& result, int32_t parentIndex);
 
     /**
      * @brief 处理 Assimp 的网格数据。
      * @param mesh Assimp 的网格对象。
-     * @param modelData 目标 ModelData 对象，用于存储顶点和索引数据。
+     * @param node 目标节点，用于存储顶点、索引和材质参数。
+     */
+    void ProcessMesh(const aiMesh* mesh, MeshCache::Node& node, const aiScene* scene);
+
+    /**
+     * @brief 为场景中的节点生成 UUID 与材质，登记子节点并发布 ModelLoadedEvent。
+     * 子节点先于父节点发布，根节点由调用方登记和发布。
+     * @param filepath 模型文件路径。
+     * @param scene 导入或从缓存读取的场景。
+     * @return ModelData 根节点的模型数据。
      */
-    void ProcessMesh(const aiMesh* mesh, ModelData& modelData, const aiScene* scene);
+    ModelData InstantiateScene(const std::string& filepath, MeshCache::Scene scene);
 
     /**
      * @brief 生成唯一的 UUID。
@@ -87,7 +148,8 @@ private:
 
     std::shared_ptr<EventBus> eventBus_;              // 事件总线实例
     std::shared_ptr<ThreadPool> threadPool_;          // 线程池实例
-    Assimp::Importer importer_;                       // Assimp 导入器实例
+    ImporterPool importerPool_;                       // 每次导入借出独占的 Assimp 导入器
+    std::shared_ptr<MeshCache> meshCache_;            // 网格缓存，可为空
     std::map<std::string, ModelData> loadedModels_; // 已加载模型的缓存
     std::shared_ptr<MaterialManager> materialManager_;    // 材质管理器
     mutable std::mutex mutex_;                        // 互斥锁，确保线程安全
@@ -0,0 +1,287 @@
+﻿#include "ObjParser.h"
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <charconv>
+#include <unordered_map>
+#include "Utils/MappedFile.h"
+
+namespace {
+    constexpr size_t kMinChunkBytes = 1 << 20;  // 每块至少 1 MB，小文件不做无意义的切分
+    constexpr size_t kChunksPerThread = 4;      // 块数多于线程数，解析速度不均时仍能均衡
+    constexpr int64_t kNoIndex = std::numeric_limits<int64_t>::min();
+    constexpr uint8_t kRelativePosition = 1;
+    constexpr uint8_t kRelativeNormal = 2;
+
+    /**
+     * @brief 一个块的解析结果，三角形的每个角记录顶点与法线索引。
+     *
+     * 正数索引已转为从 0 开始的全局索引；负数索引记为相对本块起点的下标（可能为负，指向之前的块），
+     * 在 relative 中做标记，合并时再加上之前各块的数量。
+     */
+    struct Chunk {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<int64_t> positionIndices;
+        std::vector<int64_t> normalIndices;
+        std::vector<uint8_t> relative;
+        bool missingNormal = false;
+    };
+
+    struct Cursor {
+        const char* p;
+        const char* end;
+
+        void SkipSpaces() {
+            while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        }
+        bool AtLineEnd() const {
+            return p >= end || *p == '\n' || *p == '\r';
+        }
+        void SkipLine() {
+            const void* newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+            p = newline ? static_cast<const char*>(newline) + 1 : end;
+        }
+    };
+
+    [[noreturn]] void Fail(const std::string& message) {
+        throw std::runtime_error("ObjParser: " + message);
+    }
+
+    float ParseFloat(Cursor& cursor) {
+        cursor.SkipSpaces();
+        if (cursor.p < cursor.end && *cursor.p == '+') ++cursor.p;
+        float value = 0.0f;
+        auto [next, ec] = std::from_chars(cursor.p, cursor.end, value);
+        if (ec != std::errc()) {
+            const char* token = cursor.p;
+            while (cursor.p < cursor.end && !std::isspace(static_cast<unsigned char>(*cursor.p))) ++cursor.p;
+            Fail("无效的数值 '" + std::string(token, cursor.p) + "'");
+        }
+        cursor.p = next;
+        return value;
+    }
+
+    glm::vec3 ParseVec3(Cursor& cursor) {
+        float x = ParseFloat(cursor);
+        float y = ParseFloat(cursor);
+        float z = ParseFloat(cursor);
+        return glm::vec3(x, y, z);
+    }
+
+    int64_t ParseIndex(Cursor& cursor) {
+        int64_t value = 0;
+        auto [next, ec] = std::from_chars(cursor.p, cursor.end, value);
+        if (ec != std::errc()) Fail("无效的面索引");
+        cursor.p = next;
+        return value;
+    }
+
+    /**
+     * @brief 将 OBJ 索引（从 1 开始，负数表示相对已读取的数量）转为块内表示。
+     */
+    int64_t ResolveIndex(int64_t raw, size_t localCount, uint8_t flag, uint8_t& relative) {
+        if (raw > 0) return raw - 1;
+        if (raw < 0) {
+            relative |= flag;
+            return static_cast<int64_t>(localCount) + raw;
+        }
+        Fail("面索引不能为 0");
+    }
+
+    void ParseFace(Cursor& cursor, Chunk& chunk, std::vector<int64_t>& positions, std::vector<int64_t>& normals,
+                   std::vector<uint8_t>& relative) {
+        positions.clear();
+        normals.clear();
+        relative.clear();
+        for (cursor.SkipSpaces(); !cursor.AtLineEnd(); cursor.SkipSpaces()) {
+            // 角的格式：v、v/vt、v//vn、v/vt/vn
+            uint8_t flags = 0;
+            positions.push_back(ResolveIndex(ParseIndex(cursor), chunk.positions.size(), kRelativePosition, flags));
+            int64_t normal = kNoIndex;
+            if (cursor.p < cursor.end && *cursor.p == '/') {
+                ++cursor.p;
+                if (cursor.p < cursor.end && *cursor.p != '/') {
+                    ParseIndex(cursor); // 纹理坐标，忽略
+                }
+                if (cursor.p < cursor.end && *cursor.p == '/') {
+                    ++cursor.p;
+                    normal = ResolveIndex(ParseIndex(cursor), chunk.normals.size(), kRelativeNormal, flags);
+                }
+            }
+            normals.push_back(normal);
+            relative.push_back(flags);
+            chunk.missingNormal |= normal == kNoIndex;
+        }
+
+        // 扇形三角化，少于三个角的面（点、线）忽略
+        for (size_t i = 1; i + 1 < positions.size(); ++i) {
+            for (size_t corner : {size_t(0), i, i + 1}) {
+                chunk.positionIndices.push_back(positions[corner]);
+                chunk.normalIndices.push_back(normals[corner]);
+                chunk.relative.push_back(relative[corner]);
+            }
+        }
+    }
+
+    void ParseChunk(const char* begin, const char* end, Chunk& chunk) {
+        Cursor cursor{begin, end};
+        std::vector<int64_t> positions, normals;
+        std::vector<uint8_t> relative;
+        while (cursor.p < cursor.end) {
+            cursor.SkipSpaces();
+            if (cursor.AtLineEnd()) {
+                if (cursor.p < cursor.end) cursor.SkipLine();
+                continue;
+            }
+            const char c0 = *cursor.p;
+            const char c1 = cursor.p + 1 < cursor.end ? cursor.p[1] : '\n';
+            const bool separated = c1 == ' ' || c1 == '\t';
+            if (c0 == 'v' && separated) {
+                cursor.p += 1;
+                chunk.positions.push_back(ParseVec3(cursor));
+            } else if (c0 == 'v' && c1 == 'n' && cursor.p + 2 < cursor.end && (cursor.p[2] == ' ' || cursor.p[2] == '\t')) {
+                cursor.p += 2;
+                chunk.normals.push_back(ParseVec3(cursor));
+            } else if (c0 == 'f' && separated) {
+                cursor.p += 1;
+                ParseFace(cursor, chunk, positions, normals, relative);
+            }
+            // 顶点的 w 分量与顶点颜色、注释及其他语句都跳过到行尾
+            cursor.SkipLine();
+        }
+    }
+}
+
+MeshCache::Scene ObjParser::Parse(const std::string& filepath, ThreadPool& threadPool, Stats* stats) {
+    MappedFile file;
+    try {
+        file = MappedFile(filepath);
+    } catch (const MappedFileException& e) {
+        Fail(e.what());
+    }
+    const char* data = reinterpret_cast<const char*>(file.Data());
+    const size_t size = file.Size();
+
+    // 按行边界切块：从等分点向后找到下一个换行符
+    size_t chunkCount = std::min(std::max<size_t>(1, size / kMinChunkBytes), threadPool.GetThreadCount() * kChunksPerThread);
+    std::vector<size_t> bounds{0};
+    for (size_t k = 1; k < chunkCount; ++k) {
+        size_t position = std::max(bounds.back(), size / chunkCount * k);
+        const void* newline = std::memchr(data + position, '\n', size - position);
+        if (!newline) break;
+        position = static_cast<size_t>(static_cast<const char*>(newline) - data) + 1;
+        if (position > bounds.back()) bounds.push_back(position);
+    }
+    bounds.push_back(size);
+    chunkCount = bounds.size() - 1;
+
+    std::vector<Chunk> chunks(chunkCount);
+    threadPool.ParallelFor(0, chunkCount, 1, [&](size_t c) {
+        ParseChunk(data + bounds[c], data + bounds[c + 1], chunks[c]);
+    });
+    file.Close();
+
+    // 各块之前的顶点、法线、三角形角数
+    std::vector<size_t> positionBase(chunkCount + 1, 0), normalBase(chunkCount + 1, 0), cornerBase(chunkCount + 1, 0);
+    bool hasNormals = true;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        positionBase[c + 1] = positionBase[c] + chunks[c].positions.size();
+        normalBase[c + 1] = normalBase[c] + chunks[c].normals.size();
+        cornerBase[c + 1] = cornerBase[c] + chunks[c].positionIndices.size();
+        hasNormals &= !chunks[c].missingNormal;
+    }
+    const size_t positionCount = positionBase[chunkCount];
+    const size_t normalCount = normalBase[chunkCount];
+    const size_t cornerCount = cornerBase[chunkCount];
+    hasNormals &= normalCount > 0;
+    if (positionCount > std::numeric_limits<unsigned int>::max()) Fail("顶点数量超出 32 位索引范围");
+
+    MeshCache::Scene scene;
+    scene.nodes.resize(1);
+    MeshCache::Node& node = scene.nodes[0];
+    node.transform = glm::mat4(1.0f);
+    std::vector<glm::vec3> normals;
+    std::vector<unsigned int> normalIndices;
+    node.vertices.resize(positionCount);
+    node.indices.resize(cornerCount);
+    normals.resize(hasNormals ? normalCount : 0);
+    normalIndices.resize(hasNormals ? cornerCount : 0);
+
+    // 合并各块：拷贝顶点与法线，相对索引加上之前各块的数量并检查越界
+    std::atomic<bool> sharedIndices{hasNormals && normalCount == positionCount};
+    threadPool.ParallelFor(0, chunkCount, 1, [&](size_t c) {
+        Chunk& chunk = chunks[c];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), node.vertices.begin() + positionBase[c]);
+        if (hasNormals) {
+            std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + normalBase[c]);
+        }
+        bool shared = true;
+        for (size_t i = 0; i < chunk.positionIndices.size(); ++i) {
+            int64_t position = chunk.positionIndices[i];
+            if (chunk.relative[i] & kRelativePosition) position += static_cast<int64_t>(positionBase[c]);
+            if (position < 0 || position >= static_cast<int64_t>(positionCount)) Fail("顶点索引越界");
+            node.indices[cornerBase[c] + i] = static_cast<unsigned int>(position);
+            if (hasNormals) {
+                int64_t normal = chunk.normalIndices[i];
+                if (chunk.relative[i] & kRelativeNormal) normal += static_cast<int64_t>(normalBase[c]);
+                if (normal < 0 || normal >= static_cast<int64_t>(normalCount)) Fail("法线索引越界");
+                normalIndices[cornerBase[c] + i] = static_cast<unsigned int>(normal);
+                shared &= normal == position;
+            }
+        }
+        if (!shared) sharedIndices = false;
+        chunk = Chunk{};
+    });
+
+    if (hasNormals && sharedIndices) {
+        // 顶点与法线一一对应（扫描数据常见），直接使用
+        node.normals = std::move(normals);
+    } else if (hasNormals) {
+        // 同一顶点搭配不同法线时按 (顶点, 法线) 组合拆分顶点
+        std::vector<glm::vec3> vertices;
+        std::unordered_map<uint64_t, unsigned int> combined;
+        combined.reserve(positionCount);
+        for (size_t i = 0; i < cornerCount; ++i) {
+            const uint64_t key = (static_cast<uint64_t>(node.indices[i]) << 32) | normalIndices[i];
+            auto [it, inserted] = combined.emplace(key, static_cast<unsigned int>(vertices.size()));
+            if (inserted) {
+                if (vertices.size() == std::numeric_limits<unsigned int>::max()) Fail("顶点数量超出 32 位索引范围");
+                vertices.push_back(node.vertices[node.indices[i]]);
+                node.normals.push_back(normals[normalIndices[i]]);
+            }
+            node.indices[i] = it->second;
+        }
+        node.vertices = std::move(vertices);
+    } else {
+        // 没有完整法线时按面积加权累加面法线；累加有写冲突，按顺序进行，归一化并行
+        node.normals.assign(positionCount, glm::vec3(0.0f));
+        for (size_t i = 0; i + 2 < cornerCount; i += 3) {
+            const glm::vec3& a = node.vertices[node.indices[i]];
+            const glm::vec3& b = node.vertices[node.indices[i + 1]];
+            const glm::vec3& c = node.vertices[node.indices[i + 2]];
+            const glm::vec3 faceNormal = glm::cross(b - a, c - a);
+            for (size_t k = 0; k < 3; ++k) {
+                node.normals[node.indices[i + k]] += faceNormal;
+            }
+        }
+        threadPool.ParallelFor(0, positionCount, 0, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const float length = glm::length(node.normals[i]);
+                if (length > 0.0f) node.normals[i] /= length;
+            }
+        });
+    }
+
+    if (stats) {
+        stats->bytes = size;
+        stats->chunks = chunkCount;
+        stats->positions = positionCount;
+        stats->normals = normalCount;
+        stats->triangles = cornerCount / 3;
+    }
+    return scene;
+}
\ No newline at end of file
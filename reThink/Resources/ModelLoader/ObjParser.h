@@ -0,0 +1,38 @@
+﻿#pragma once
+#include <string>
+#include <cstddef>
+#include "MeshCache.h"
+#include "ThreadPool/ThreadPool.h"
+
+/**
+ * @brief 大型 OBJ 文件的多线程解析器，不经过 Assimp。
+ *
+ * 文件整体映射后按行边界切成若干块，由线程池并行解析；各块独立记录顶点、法线与三角形，
+ * 相对（负数）索引先按块内计数记下，合并时加上之前各块的数量得到全局索引。多边形按扇形三角化。
+ *
+ * 只读取几何数据：v、vn 与 f，其余语句（vt、o、g、usemtl、mtllib 等）被忽略，结果为单个节点。
+ * 面的各顶点都带法线时使用文件中的法线，否则按面积加权生成平滑法线，与 Assimp 的导入选项一致。
+ */
+class ObjParser {
+public:
+    /**
+     * @brief 解析统计。
+     */
+    struct Stats {
+        size_t bytes = 0;      // 文件大小
+        size_t chunks = 0;     // 并行解析的块数
+        size_t positions = 0;  // 文件中的顶点数量
+        size_t normals = 0;    // 文件中的法线数量
+        size_t triangles = 0;  // 三角化后的三角形数量
+    };
+
+    /**
+     * @brief 解析 OBJ 文件。
+     * @param filepath 文件路径。
+     * @param threadPool 用于并行解析的线程池，可在其工作线程中调用。
+     * @param stats 可选的统计输出。
+     * @return MeshCache::Scene 只有一个根节点的场景。
+     * @throws std::runtime_error 文件无法读取、数值格式错误或索引越界时抛出。
+     */
+    static MeshCache::Scene Parse(const std::string& filepath, ThreadPool& threadPool, Stats* stats = nullptr);
+};
\ No newline at end of file
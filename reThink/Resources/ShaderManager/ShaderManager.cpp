@@ -134,6 +134,40 @@ void main() {
     } else {
         std::cout << "默认着色器编译成功, 程序ID: " << program << std::endl;
     }
+
+    // 实例化绘制使用的着色器：顶点着色器额外读取逐实例变换，片段着色器与默认着色器共用
+    std::string instancedVertexPath = "Shaders/instanced.vs";
+    if (!fs::exists(instancedVertexPath)) {
+        std::ofstream file(instancedVertexPath);
+        if (file.is_open()) {
+            file << R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in mat4 aInstance;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+out vec3 FragPos;
+out vec3 Normal;
+void main() {
+    mat4 world = model * aInstance;
+    FragPos = vec3(world * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(world))) * aNormal;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+            file.close();
+        }
+    }
+
+    CompileShaderTask(instancedVertexPath, defaultFragmentPath);
+    program = GetShaderProgram(instancedVertexPath, defaultFragmentPath);
+    if (program == 0) {
+        std::cerr << "错误: 实例化着色器编译失败!" << std::endl;
+    } else {
+        std::cout << "实例化着色器编译成功, 程序ID: " << program << std::endl;
+    }
 }
 
 GLuint ShaderManager::CompileShader(GLenum shaderType, const std::string& source, std::string& errorMessage) {